@@ -7,6 +7,12 @@
 #include <vector>
 #include <utility>
 #include <unordered_map>
+#include <array>
+#include <optional>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <thread>
 
 class User {
     private:
@@ -18,26 +24,60 @@ class User {
 
         std::string getUsername() const { return username; }
         std::string getPassword() const { return password; }
+        bool checkPassword(const std::string& input) const; // 固定時間比對
 };
 
 class AccountSystem {
         friend class JudgeSystem;
     private:
-        std::unordered_map<std::string, User> userMap;
-        std::string loginUser;
+        // 使用者與 session 依 key 的 hash 分散到多個 shard，各自持有讀寫鎖，
+        // 讓大量同時登入時不會全部卡在同一把鎖上。
+        static constexpr size_t SHARD_COUNT = 16;
+        struct Shard {
+            mutable std::shared_mutex mutex;
+            std::unordered_map<std::string, User> userMap;
+            std::unordered_map<std::string, std::string> sessionMap; // token -> username
+        };
+        std::array<Shard, SHARD_COUNT> shards;
+
+        std::string loginToken; // 目前終端機使用者的 session token
         std::string userDataPath;
 
+        // write-behind：新增使用者只標記 dirty，由背景執行緒批次寫回檔案。
+        std::mutex flushMutex;
+        std::condition_variable flushCv;
+        bool dirty = false;
+        bool stopping = false;
+        std::thread flusher;
+
+        Shard& shardOf(const std::string& key);
+        const Shard& shardOf(const std::string& key) const;
+
+        std::string createSession(const std::string& username);
         bool signUp();
         void userDataUpdate();
-        
+        void flushLoop();
+
     protected:
         void init(const std::string& userDataPath);
-        User* search(const std::string& username);
+        std::optional<User> search(const std::string& username) const;
         std::pair<bool, std::string> login();
         void addUser(const std::string& username, const std::string& password);
-        bool verifyPassword(User* user);
+        bool verifyPassword(const User& user);
+
+        std::string getuserLogin() const { return sessionUser(loginToken); }
+
+    public:
+        AccountSystem() = default;
+        ~AccountSystem();
+        AccountSystem(const AccountSystem&) = delete;
+        AccountSystem& operator=(const AccountSystem&) = delete;
 
-        std::string getuserLogin() const {return loginUser;}
+        // 非互動式 API，可由多個執行緒同時呼叫。
+        std::string authenticate(const std::string& username, const std::string& password); // 成功回傳 token，失敗回傳空字串
+        std::string sessionUser(const std::string& token) const;                              // token 無效時回傳空字串
+        void logout(const std::string& token);
+        bool registerUser(const std::string& username, const std::string& password);          // 名稱已存在或含有 ',' 時回傳 false
 };
 
-#endif // ACCOUNT_HPP
\ No newline at end of file
+#endif // ACCOUNT_HPP
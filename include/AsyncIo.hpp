@@ -0,0 +1,36 @@
+// AsyncIo.hpp
+
+#ifndef ASYNC_IO_HPP
+#define ASYNC_IO_HPP
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+// 評測用的 I/O 層。Linux 上優先使用 io_uring (直接呼叫系統呼叫，不依賴 liburing)，
+// 一次送出多個讀寫請求以減少系統呼叫次數；io_uring 無法使用時 (舊核心、被 seccomp 擋下、
+// 或非 Linux 平台) 自動退回原本的阻塞式讀檔與 poll()。
+
+bool asyncIoAvailable();
+
+// 批次讀取多個檔案的完整內容；無法讀取的檔案回傳空字串。
+std::vector<std::string> readFiles(const std::vector<fs::path>& paths);
+
+#ifndef _WIN32
+struct PipeResult {
+    bool timedOut = false;    // 到達 deadline 時仍未結束
+    bool overflow = false;    // 輸出超過 outputLimit
+    bool ioError = false;     // 評測端的 I/O 失敗，無法得知寫入與讀取進度，輸出不完整
+    std::string output;
+};
+
+// 將 input 寫入受測程式的 stdin (inFd)，同時從其 stdout (outFd) 讀取輸出，直到 EOF。
+// 兩個 fd 都會在函式內關閉。
+PipeResult pumpPipes(int inFd, int outFd, const std::string& input, size_t outputLimit,
+                     std::chrono::steady_clock::time_point deadline);
+#endif
+
+#endif // ASYNC_IO_HPP
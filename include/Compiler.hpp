@@ -0,0 +1,62 @@
+// Compiler.hpp
+
+#ifndef COMPILER_HPP
+#define COMPILER_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+
+// 編譯參數組合。同一組參數共用一份預編譯標頭 (PCH) 與編譯快取。
+struct CompileProfile {
+    std::string name;    // e.g., "default"，同時作為 build/pch/<name> 的資料夾名稱
+    std::string flags;   // e.g., "-O2 -std=c++17"
+};
+
+const CompileProfile& defaultProfile();
+
+// 編譯服務：
+//   1. 在背景為常用標頭 (<bits/stdc++.h>、<iostream>) 預先建立 PCH，
+//      第一個 #include 是這些標頭的提交就能跳過解析標頭的時間。
+//   2. 以「原始碼 + 編譯參數 + 編譯器版本」的 SHA-256 為 key 快取執行檔，重複提交 (例如重播、重新評測) 不必再次編譯。
+//      快取大小以 JUDGE_CACHE_MB 限制 (預設 256 MB)，超過時淘汰最久未使用的執行檔。
+// g++ 本身無法常駐，因此「保持編譯器就緒」以上述兩種方式達成；產生的執行檔與直接編譯完全相同。
+class CompileService {
+public:
+    static CompileService& instance();
+    ~CompileService();
+    CompileService(const CompileService&) = delete;
+    CompileService& operator=(const CompileService&) = delete;
+
+    void warmUp(const CompileProfile& profile = defaultProfile()); // 在背景建立 PCH，不會阻塞
+    bool compile(const std::string& codePath, const std::string& binaryPath,
+                 const CompileProfile& profile = defaultProfile());
+
+private:
+    CompileService() = default;
+
+    struct PchState {
+        std::atomic<bool> ready{false};
+    };
+
+    std::mutex mutex;
+    std::map<std::string, std::shared_ptr<PchState>> pchStates; // profile name -> 狀態
+    std::vector<std::thread> builders;
+    std::string compilerVersion;
+
+    std::mutex cacheMutex;
+    uintmax_t cacheBytes = 0;        // build/cache 目前的大小
+    bool cacheScanned = false;
+
+    const std::string& getCompilerVersion();
+    void buildPch(const CompileProfile& profile, std::shared_ptr<PchState> state);
+    bool pchReady(const CompileProfile& profile);
+    void trimCache(uintmax_t added);
+};
+
+#endif // COMPILER_HPP
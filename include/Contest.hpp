@@ -0,0 +1,120 @@
+// Contest.hpp
+
+#ifndef CONTEST_HPP
+#define CONTEST_HPP
+
+#include <string>
+#include <vector>
+#include <tuple>
+#include <mutex>
+#include <unordered_map>
+#include <ext/pb_ds/assoc_container.hpp>
+#include <ext/pb_ds/tree_policy.hpp>
+#include "Problem.hpp"
+
+enum class ContestMode { ICPC, IOI };
+std::string contestModeName(ContestMode mode);                // e.g., "ICPC"
+bool parseContestMode(const std::string& s, ContestMode& mode);
+
+struct ContestConfig {
+    std::string name;
+    ContestMode mode = ContestMode::ICPC;
+    long long start = 0;                  // 開始時間 (epoch 秒)
+    long long end = 0;                    // 結束時間 (epoch 秒)
+    long long freezeMinutes = 0;          // 結束前幾分鐘封榜，0 表示不封榜
+    std::vector<std::string> problems;    // 比賽使用的題目標題
+    bool unfrozen = false;                // 比賽結束後管理員已公布最終排名
+};
+
+// 排行榜的一列
+struct ScoreRow {
+    int rank;
+    std::string username;
+    long long score;                      // ICPC：解題數；IOI：總分
+    long long penalty;                    // ICPC：罰時 (分鐘)；IOI：0
+    std::vector<std::string> cells;       // 每題的顯示內容，e.g., "+1 (35)"、"-2"、"?1"、"70"
+};
+
+// 增量維護的排名。每位參賽者在 order-statistics tree 中有一個 key，
+// 每筆結果只需移除舊 key 再插入新 key，名次與前 K 名的查詢都是 O(log n)，不需要重新排序。
+class Standings {
+public:
+    explicit Standings(ContestMode mode = ContestMode::ICPC, size_t problemCount = 0);
+
+    // score 只用於 IOI (該次提交的分數 0-100)；minute 為比賽開始後經過的分鐘數
+    void apply(const std::string& user, size_t problem, Verdict verdict, int score, long long minute);
+    void markPending(const std::string& user, size_t problem); // 封榜期間的提交只顯示為待定 (已解出的題目除外)
+    int rankOf(const std::string& user) const;                 // 不在榜上時回傳 -1
+    std::vector<ScoreRow> top(size_t k) const;
+    std::vector<ScoreRow> row(const std::string& user) const;  // 該參賽者的一列 (不在榜上時為空)
+    size_t size() const { return entries.size(); }
+
+private:
+    struct Cell {
+        int tries = 0;                    // ICPC：AC 前計入罰時的失敗次數；IOI：提交次數
+        int pending = 0;                  // 封榜後的提交數
+        bool solved = false;
+        long long solvedAt = 0;           // ICPC：AC 的分鐘數
+        int score = 0;                    // IOI：最高分
+    };
+    struct Entry {
+        std::string user;
+        std::vector<Cell> cells;
+        long long score = 0;
+        long long penalty = 0;
+    };
+    // (-score, penalty, username)：越小排名越前；相同 score 與 penalty 的參賽者名次相同
+    using Key = std::tuple<long long, long long, std::string>;
+    using RankTree = __gnu_pbds::tree<Key, __gnu_pbds::null_type, std::less<Key>,
+                                      __gnu_pbds::rb_tree_tag, __gnu_pbds::tree_order_statistics_node_update>;
+
+    ContestMode mode;
+    size_t problemCount;
+    RankTree tree;
+    std::unordered_map<std::string, Entry> entries;
+
+    static Key keyOf(const Entry& entry);
+    Entry& entryOf(const std::string& user);
+    int rankOfKey(const Key& key) const;
+    ScoreRow rowOf(const Entry& entry) const;
+};
+
+// 比賽：設定存於 <dir>/contest.csv，每筆計入比賽的提交附加到 <dir>/submissions.csv，
+// 啟動時依序重新套用即可還原排行榜。
+// 同時維護兩份排行榜：live 為即時結果 (管理員可見)，board 為公開排行榜，封榜期間不再更新名次。
+class Contest {
+public:
+    explicit Contest(std::string directory);   // e.g., "data/contest"
+
+    bool load();                                // 沒有進行中的比賽設定時回傳 false
+    bool create(const ContestConfig& config);   // 建立新比賽，先前的提交紀錄改名保存
+
+    // 記錄一次提交；不在比賽時間內或題目不屬於比賽時回傳 false
+    bool submit(const std::string& user, const std::string& problemTitle, Verdict verdict,
+                size_t passed, size_t total, long long when);
+    bool unfreeze();                            // 比賽結束後公布封榜期間的結果
+
+    std::vector<ScoreRow> scoreboard(size_t k, bool live) const;
+    std::vector<ScoreRow> userRow(const std::string& user, bool live) const;
+    size_t participants() const;
+    std::string exportSnapshot(bool live) const; // 回傳輸出的檔案路徑，失敗時回傳空字串
+
+    ContestConfig getConfig() const;
+    bool isRunning(long long now) const;
+    bool isFrozen(long long now) const;         // 公開排行榜目前是否處於封榜狀態
+    bool hasProblem(const std::string& title) const;
+
+private:
+    std::string directory;
+    ContestConfig config;
+    Standings live;
+    Standings board;
+    mutable std::mutex mutex;
+
+    int problemIndex(const std::string& title) const;
+    bool frozenLocked(long long now) const;
+    void applyLocked(const std::string& user, int problem, Verdict verdict, int score, long long when);
+    bool saveConfigLocked() const;
+};
+
+#endif // CONTEST_HPP
@@ -0,0 +1,81 @@
+// Cpu.hpp
+
+#ifndef CPU_HPP
+#define CPU_HPP
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+
+class CorePool;
+
+// 解析 "0-3,8,10-11" 格式的 CPU 清單 (排序、去除重複；格式錯誤的片段略過)
+std::vector<int> parseCpuList(const std::string& text);
+
+// 核心的分配結果：受測程式綁在 judge 上，判題系統自己的執行緒與 g++ 限制在 housekeeping 上
+struct CoreLayout {
+    std::vector<int> judge;
+    std::vector<int> housekeeping;
+};
+
+// 依可用核心 allowed、JUDGE_CPUS 設定 requested (空字串表示未設定) 分配核心。
+// avoidSmt 時同一實體核心只取一個邏輯核心，siblings(cpu) 回傳與 cpu 同一實體核心的邏輯核心。
+CoreLayout planCores(const std::vector<int>& allowed, const std::string& requested, bool avoidSmt,
+                     const std::function<std::vector<int>(int)>& siblings);
+
+// 借用中的 CPU 核心；解構時歸還。cpu 為 -1 表示此平台不支援綁核。
+class CoreLease {
+private:
+    CorePool* pool = nullptr;
+    int cpu = -1;
+
+public:
+    CoreLease() = default;
+    CoreLease(CorePool* pool, int cpu);
+    ~CoreLease();
+    CoreLease(CoreLease&& other) noexcept;
+    CoreLease& operator=(CoreLease&& other) noexcept;
+    CoreLease(const CoreLease&) = delete;
+    CoreLease& operator=(const CoreLease&) = delete;
+
+    int get() const { return cpu; }
+};
+
+// 評測用的 CPU 核心池。每個受測程式獨占一個核心，同時執行的程式不會搶同一個核心與快取。
+//
+// 設定 (環境變數)：
+//   JUDGE_CPUS=2-5,8   評測使用的核心；未設定時使用所有可用核心，但保留約四分之一 (至少一個) 給判題系統本身
+//   JUDGE_SMT=1        允許使用同一實體核心上的 SMT sibling (預設會避開)
+//
+// 受測程式綁在評測核心上，判題系統自己的執行緒與 g++ 一律限制在其餘的 housekeeping 核心上，
+// 編譯再多也不會搶到正在計時的程式的核心；同時進行的編譯數量由 JudgePipeline 依 housekeeping 核心數限制。
+// 只有一個核心可用時無法分開，兩者共用。
+class CorePool {
+    friend class CoreLease;
+private:
+    std::vector<int> cores;       // 評測用核心
+    std::vector<int> housekeeping; // 判題系統與編譯使用的核心，無法綁核或只有一個核心時為空
+    std::vector<int> freeCores;
+    double scale = 1.0;           // 時間限制的倍率 (由 calibrate 決定)
+    bool calibrated = false;
+    std::mutex mutex;
+    std::condition_variable available;
+
+    CorePool();
+    void release(int cpu);
+
+public:
+    static CorePool& instance();
+    CorePool(const CorePool&) = delete;
+    CorePool& operator=(const CorePool&) = delete;
+
+    CoreLease acquire();                // 沒有空閒核心時阻塞
+    double calibrate();                 // 在編譯負載下測量計時誤差並回傳時間限制倍率 (只會執行一次)
+    double timeScale() const { return scale; }
+    const std::vector<int>& getCores() const { return cores; }
+    const std::vector<int>& getHousekeeping() const { return housekeeping; }
+};
+
+#endif // CPU_HPP
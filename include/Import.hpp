@@ -0,0 +1,30 @@
+// Import.hpp
+
+#ifndef IMPORT_HPP
+#define IMPORT_HPP
+
+#include <string>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+// 從 tar / tar.gz 封存檔匯入測資。封存檔只讀一次：讀取端依序解析 tar header，
+// 內容切成區塊交給多個寫入執行緒，依 offset 直接寫入暫存資料夾，全部寫完並驗證後才替換 testcases。
+// 封存檔內的目錄結構會被忽略，只看檔名：*.in / *.out 為測資，description.txt 為題目敘述，其餘略過。
+struct ImportReport {
+    size_t cases = 0;                 // 成功配對的 .in/.out 數量
+    size_t skipped = 0;               // 略過的其他檔案
+    unsigned long long bytes = 0;     // 寫入的總位元組數
+    bool hasDescription = false;
+    std::string error;                // 失敗原因，成功時為空字串
+};
+
+// 將封存檔解開到 stagingDir (必須不存在)，並檢查每個 .in 都有對應的 .out。
+// 失敗時回傳 false 並把原因寫入 report.error；stagingDir 由呼叫端清除。
+bool extractTestArchive(const std::string& archivePath, const fs::path& stagingDir, ImportReport& report);
+
+// 以 staging 資料夾替換 target。Linux 上以 RENAME_EXCHANGE 一次交換，其他平台退回兩次 rename。
+// 成功後 staging 會被刪除。
+bool replaceDirectory(const fs::path& staging, const fs::path& target);
+
+#endif // IMPORT_HPP
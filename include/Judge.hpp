@@ -17,6 +17,9 @@ private:
     std::string version;
     std::string status;
 
+    void scoreboardProcess();   // 顯示比賽排行榜 (管理員可輸出快照、公布封榜結果)
+    void newContestProcess();   // 建立新比賽 (admin only)
+
 public:
     JudgeSystem() = default;
     JudgeSystem(const std::string& userPath,
@@ -26,6 +29,9 @@ public:
     void loadData();
     void loginProcess();
     bool mainPageProcess();
+    void replayProcess(const std::string& tracePath, double speed);
+    void similarityProcess(const std::string& directory, double threshold);
+    bool importProcess(const std::string& archivePath, const std::string& title, int timeLimitMs);
 
     std::string getUserPath() const { return userDataPath; }
     std::string getProblemPath() const { return problemDataPath; }
@@ -6,35 +6,95 @@
 #include <string>
 #include <vector>
 #include <filesystem>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <optional>
+#include <future>
 
 namespace fs = std::filesystem;
 
+// 判題結果
+enum class Verdict { Accepted, WrongAnswer, RuntimeError, TimeLimitExceeded, CompileError };
+std::string verdictName(Verdict v);                  // e.g., "AC"
+bool parseVerdict(const std::string& s, Verdict& v); // "AC" -> Verdict::Accepted
+
 class Problem {
 private:
     std::string title;      // e.g., "Problem Title"
     std::string basePath;   // e.g., "problem/problem-name"
+    int timeLimitMs;        // 每筆測資的 CPU 時間上限
 
 public:
-    Problem(std::string t, std::string b);
+    static constexpr int DEFAULT_TIME_LIMIT_MS = 1000;
+
+    Problem(std::string t, std::string b, int limitMs = DEFAULT_TIME_LIMIT_MS);
     std::string getTitle() const { return title; };
     std::string getBasePath() const { return basePath; }
+    int getTimeLimitMs() const { return timeLimitMs; }
 };
 
+// 一筆測資。內容載入記憶體後不再改變，評測中的提交會一直使用開始時拿到的版本。
+struct Testcase {
+    std::string name;                              // e.g., "1"
+    std::shared_ptr<const std::string> input;
+    std::shared_ptr<const std::string> expected;
+};
+using TestcaseSet = std::vector<Testcase>;
+using ProblemList = std::vector<Problem>;
+
+class TraceRecorder;
+class SimilarityIndex;
+class CatalogWatcher;
+class Contest;
+class JudgePipeline;
+
 class ProblemSystem {
     friend class JudgeSystem;
 private:
-    std::vector<Problem> problemList;
+    // 題目清單與測資都以不可變的快照 (shared_ptr<const ...>) 提供，
+    // 重新載入時只替換指標，正在使用舊快照的評測不受影響。
+    std::shared_ptr<const ProblemList> problemList = std::make_shared<const ProblemList>();
+    std::string catalogPath;
+    std::mutex catalogMutex;                       // 序列化對 problemList 的更新
+
+    struct TestdataEntry {
+        unsigned long long generation = 0;         // 每次測資變動 +1，避免放入過期的載入結果
+        std::shared_ptr<const TestcaseSet> testcases;
+    };
+    std::mutex testdataMutex;
+    std::unordered_map<std::string, TestdataEntry> testdataCache; // basePath -> 測資快取
+
+    std::shared_ptr<TraceRecorder> recorder;     // 記錄每次提交，供之後重播
+    std::shared_ptr<SimilarityIndex> similarity; // 所有提交的相似度索引
+    std::shared_ptr<Contest> contest;            // 比賽設定與排行榜 (沒有比賽時仍存在，設定為空)
+
+    std::mutex judgeMutex;
+    std::unordered_map<size_t, std::promise<std::pair<Verdict, size_t>>> pendingJudges; // id -> (結果, 通過數)
+    size_t nextJudgeId = 0;
+    std::shared_ptr<JudgePipeline> pipeline;     // 所有提交共用，第一次評測時才建立
+    std::shared_ptr<CatalogWatcher> watcher;     // 最後宣告，確保最先解構 (它會回呼 ProblemSystem)
+
+    void reloadCatalog();
+    void invalidateTestdata(const std::string& basePath);
+    Verdict judgeOnPipeline(const std::string& codePath, std::shared_ptr<const TestcaseSet> testcases,
+                            int timeLimitMs, bool verbose, size_t* passed = nullptr);
 
 public:
+    // 以下回傳 Problem 的函式都從同一份快照複製，之後題目清單重新載入也不影響呼叫端
     void init(const std::string& problemDataPath);
-    bool listAllProblems() const;
-    bool printProblemDescription(int id) const;
-    int randomProblem() const;
-    void submitCode(const int id);
+    std::shared_ptr<const ProblemList> listAllProblems() const; // 回傳顯示的快照，沒有題目時回傳 nullptr
+    void printProblemDescription(const Problem& problem) const;
+    std::optional<Problem> randomProblem() const;
+    Verdict submitCode(const Problem& problem, const std::string& username = "");
+    Verdict judge(const Problem& problem, const std::string& codePath, bool verbose = true);
+    std::optional<Problem> findProblem(const std::string& title) const;
     void addProblem(const Problem& p);
     void newProblemSet(const std::string& problemDataPath);
-    std::vector<fs::path> testcasePrepare(const int id);
-    const std::vector<Problem>& getProblemList() const { return problemList; };
+    // 從 tar / tar.gz 匯入測資；題目不存在時一併建立 (timeLimitMs <= 0 表示使用預設值)
+    bool importTestcases(const std::string& title, const std::string& archivePath, int timeLimitMs = 0);
+    std::shared_ptr<const TestcaseSet> testcasePrepare(const Problem& problem); // 失敗時回傳 nullptr
+    std::shared_ptr<const ProblemList> getProblemList() const;
 };
 
 #endif // PROBLEM_HPP
\ No newline at end of file
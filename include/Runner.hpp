@@ -0,0 +1,89 @@
+// Runner.hpp
+
+#ifndef RUNNER_HPP
+#define RUNNER_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <filesystem>
+#include "Problem.hpp"
+#include "Workspace.hpp"
+
+namespace fs = std::filesystem;
+
+enum class RunStatus { Ok, RuntimeError, TimeLimitExceeded };
+
+struct RunResult {
+    RunStatus status;
+    double cpuMs;                 // 受測程式使用的 CPU 時間 (user + sys)
+    std::string output;           // 受測程式的標準輸出
+};
+
+bool compileCode(const std::string& codePath, const RunTarget& target);
+// 在獨占的核心上執行程式，input 作為標準輸入；timeLimitMs 會再乘上 CorePool 校正出的倍率
+RunResult runCode(const RunTarget& target, const std::string& input, int timeLimitMs);
+bool compareOutput(const std::string& expected, const std::string& actual);
+
+// 執行已編譯好的程式並逐一比對測資。passed 不為 nullptr 時 (部分給分) 不會在第一筆失敗時停止，
+// 而是跑完所有測資並回傳通過的數量；回傳的結果仍是第一筆失敗的結果。
+Verdict runTestcases(const RunTarget& target, const TestcaseSet& testcases, int timeLimitMs, bool verbose,
+                     size_t* passed = nullptr);
+// 向 WorkspacePool 借用工作區，編譯後執行所有測資
+Verdict compileAndRun(const std::string& codePath, const TestcaseSet& testcases, int timeLimitMs, bool verbose,
+                      size_t* passed = nullptr);
+
+struct JudgeJob {
+    size_t index;                 // 由呼叫端決定的編號，完成時原樣傳回
+    std::string codePath;
+    std::shared_ptr<const TestcaseSet> testcases;
+    int timeLimitMs;
+    bool verbose = false;         // 輸出編譯與每筆測資的結果 (互動提交)
+    bool partial = false;         // 部分給分：跑完所有測資並回報通過的數量
+};
+
+// 編譯與執行分成兩個階段的管線：第 N+1 份提交編譯時，第 N 份提交的測資可以同時執行。
+// 兩個階段之間以有界佇列 (bounded queue) 相連，編譯太快時會被擋下，避免堆積大量執行檔。
+// 所有 worker 共用，每次依目前佇列狀況挑選階段 (優先執行已編譯好的程式)，
+// 因此兩個階段實際使用的 worker 數會隨提交內容自動調整。
+// 同時進行的編譯數不超過 housekeeping 核心數 (至少一個)，g++ 不會彼此搶核心；
+// workerCount / queueCapacity 為 0 時依 CorePool 決定：評測核心數 + 編譯上限。
+class JudgePipeline {
+public:
+    using Callback = std::function<void(size_t index, Verdict verdict, size_t passed)>; // passed 只在 partial 時有意義
+
+    explicit JudgePipeline(Callback onDone, size_t workerCount = 0, size_t queueCapacity = 0);
+    ~JudgePipeline();
+    JudgePipeline(const JudgePipeline&) = delete;
+    JudgePipeline& operator=(const JudgePipeline&) = delete;
+
+    void submit(JudgeJob job); // 編譯佇列已滿時會阻塞
+    void finish();             // 等待所有已提交的工作完成並結束 worker
+
+private:
+    struct CompiledJob {
+        JudgeJob job;
+        WorkspaceLease workspace;
+    };
+
+    std::deque<JudgeJob> compileQueue;
+    std::deque<CompiledJob> runQueue;
+    size_t queueCapacity;
+    size_t compileLimit;       // 同時編譯的上限
+    size_t compiling = 0;      // 正在編譯、尚未放進 runQueue 的數量
+    bool closed = false;
+
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable spaceAvailable;
+    std::vector<std::thread> workers;
+    Callback onDone;
+
+    void workerLoop();
+};
+
+#endif // RUNNER_HPP
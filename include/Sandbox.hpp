@@ -0,0 +1,119 @@
+// Sandbox.hpp
+
+#ifndef SANDBOX_HPP
+#define SANDBOX_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+
+// 沙箱中執行一次受測程式的參數
+struct SandboxRequest {
+    std::string binaryPath;           // 由判題系統開啟後以 fd 傳給沙箱 (工作區不會掛載進沙箱)
+    int cpu = -1;                     // 綁定的核心，-1 表示不綁核
+    unsigned long long cpuLimitSec = 0;
+    unsigned long long fileLimitBytes = 0;
+};
+
+struct SandboxResult {
+    bool ok = false;                  // false 代表沙箱本身故障，這次執行沒有結果
+    bool retryable = false;           // 故障發生在受測程式開始執行之前，可以換一個沙箱重新執行
+    bool timedOut = false;            // 超過牆上時間被強制結束
+    bool overflow = false;            // 輸出超過上限被強制結束
+    int status = 0;                   // wait4 的 status
+    double cpuMs = 0;
+    std::string output;
+};
+
+// 一個預先建立好的沙箱：以 user/mount/pid/net namespace 隔離、放在自己的 cgroup v2 leaf 中的常駐程序。
+// 它是沙箱 pid namespace 的 PID 1，收到執行請求時 fork 出受測程式；每次執行結束後
+// 以 kill(-1) 清掉沙箱內所有殘留的程序，就能直接給下一次執行使用。
+struct Sandbox {
+    int pid = -1;                     // 沙箱 init 在外部看到的 pid
+    int sock = -1;                    // 與 init 溝通的 SOCK_SEQPACKET
+    std::string cgroup;               // cgroup leaf 的路徑，沒有 cgroup 時為空字串
+};
+
+class SandboxPool;
+
+// 借用中的沙箱；解構時歸還 (故障的沙箱交給背景執行緒回收並補上新的)。
+class SandboxLease {
+private:
+    SandboxPool* pool = nullptr;
+    std::unique_ptr<Sandbox> sandbox;
+    bool broken = false;
+
+public:
+    SandboxLease() = default;
+    SandboxLease(SandboxPool* pool, std::unique_ptr<Sandbox> sandbox);
+    ~SandboxLease();
+    SandboxLease(SandboxLease&& other) noexcept;
+    SandboxLease& operator=(SandboxLease&& other) noexcept;
+    SandboxLease(const SandboxLease&) = delete;
+    SandboxLease& operator=(const SandboxLease&) = delete;
+
+    explicit operator bool() const { return sandbox != nullptr; }
+    // 將 input 餵給受測程式並收集輸出，最多執行到 deadline
+    SandboxResult run(const SandboxRequest& request, const std::string& input,
+                      std::chrono::steady_clock::time_point deadline);
+};
+
+// 沙箱池。建立 namespace、掛載最小的根目錄與建立 cgroup 都在背景執行緒中事先完成，
+// 評測時只需借出一個沙箱並送出請求，隔離的額外成本只剩一次 fork 與 socket 往返。
+//
+// 設定 (環境變數)：
+//   JUDGE_SANDBOX=0       停用沙箱，直接 fork 執行受測程式
+//   JUDGE_MEMORY_MB=1024  每個沙箱的記憶體上限 (需要 cgroup v2 的 memory controller)
+//
+// 核心不支援 user namespace 或沒有權限時自動停用，評測照常以一般方式執行。
+// 一旦啟用就不會在執行期間退回一般方式：沙箱故障時該次執行以錯誤計，不會在隔離之外執行。
+class SandboxPool {
+    friend class SandboxLease;
+private:
+    std::vector<std::unique_ptr<Sandbox>> ready;     // 可以直接借出的沙箱
+    std::vector<std::unique_ptr<Sandbox>> retiring;  // 等待回收的沙箱
+    size_t target = 0;                               // 沙箱總數 (含借出中的)
+    size_t total = 0;                                // 目前存在的沙箱數 (含借出中的)
+    size_t nextId = 0;
+    bool started = false;
+    bool disabled = false;
+    bool stopping = false;
+    std::string status;                              // 給 loadData 顯示的狀態
+    std::string selfExe;
+    std::string mountDir;                            // 沙箱內 tmpfs 根目錄的掛載點 (位於工作區根目錄下)
+    std::string cgroupRoot;                          // e.g., "/sys/fs/cgroup/judge-123"，無法使用時為空字串
+    long long memoryLimitBytes = 0;                  // 每個沙箱的記憶體上限，0 表示沒有限制
+    bool pidsLimit = false;                          // pids controller 可用，每個沙箱限制程序數
+
+    std::mutex mutex;
+    std::condition_variable readyCv;
+    std::condition_variable warmCv;
+    std::thread warmer;
+
+    SandboxPool() = default;
+    std::unique_ptr<Sandbox> spawn(std::string& error);
+    void destroy(std::unique_ptr<Sandbox> sandbox);
+    void release(std::unique_ptr<Sandbox> sandbox, bool broken);
+    void warmLoop();
+
+public:
+    static SandboxPool& instance();
+    ~SandboxPool();
+    SandboxPool(const SandboxPool&) = delete;
+    SandboxPool& operator=(const SandboxPool&) = delete;
+
+    // 建立第一個沙箱 (確認環境支援) 後，由背景執行緒補滿 size 個；重複呼叫不會有作用
+    void warmUp(size_t size);
+    bool enabled();                  // warmUp 已確認環境支援沙箱
+    SandboxLease acquire();          // 沙箱停用或等不到可用的沙箱時回傳空的 lease
+    std::string getStatus();
+};
+
+// main() 收到 --sandbox-init 時呼叫：沙箱 init 的進入點 (已在新的 namespace 中)
+int sandboxInitMain(int argc, char* argv[]);
+
+#endif // SANDBOX_HPP
@@ -0,0 +1,78 @@
+// Similarity.hpp
+
+#ifndef SIMILARITY_HPP
+#define SIMILARITY_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <shared_mutex>
+
+// 一個 winnowing 指紋：k 個連續 token 的 hash，以及它在原始碼中涵蓋的行數範圍
+struct Fingerprint {
+    uint64_t hash;
+    int firstLine;
+    int lastLine;
+};
+
+// 兩份程式碼中相似的片段 (行數皆為 1-based、包含兩端)
+struct MatchedRegion {
+    int firstLineA, lastLineA;
+    int firstLineB, lastLineB;
+};
+
+struct SimilarityMatch {
+    std::string pathA;
+    std::string pathB;
+    double score;                        // 共同指紋數 / 指紋較少一方的指紋數 (皆不含樣板指紋)
+    std::vector<MatchedRegion> regions;
+};
+
+// 將 C++ 原始碼切成 token (識別字、數字、字串統一正規化，忽略註解與前置處理指令)，
+// 再以 winnowing 選出指紋。改變數名稱、空白或註解不會影響結果。
+std::vector<Fingerprint> fingerprintSource(const std::string& source, size_t k, size_t window);
+
+// 所有提交的指紋倒排索引 (hash -> 含有該指紋的文件)。
+// 新提交只需要查詢自己擁有的指紋，不必與每一份歷史提交逐一比對。
+class SimilarityIndex {
+private:
+    struct Document {
+        std::string path;
+        std::vector<Fingerprint> fingerprints;
+        bool active;                     // 同一路徑重新加入時，舊版本標記為失效
+    };
+
+    size_t k;
+    size_t window;
+    double threshold;
+    std::vector<Document> documents;
+    std::unordered_map<std::string, size_t> documentByPath;
+    std::unordered_map<uint64_t, std::vector<size_t>> postings; // 只含有效的文件，長度不超過 MAX_POSTINGS
+    std::unordered_set<uint64_t> commonHashes;                    // 出現在太多文件中、不再建立索引的指紋 (永久，不會移回)
+    mutable std::shared_mutex mutex;
+
+    void deactivate(size_t id);
+    std::vector<SimilarityMatch> findMatches(const std::string& path, const std::vector<Fingerprint>& fingerprints,
+                                             size_t firstId) const;
+    std::vector<SimilarityMatch> insert(const std::string& path, std::vector<Fingerprint> fingerprints);
+
+public:
+    static constexpr size_t MAX_POSTINGS = 64; // 單一指紋最多對應的文件數，查詢成本因此與歷史提交數無關
+
+    SimilarityIndex(size_t k = 12, size_t window = 8, double threshold = 0.5);
+
+    // 以多執行緒計算資料夾內所有 .cpp 的指紋並建立索引；report 不為 nullptr 時回傳所有相似的配對
+    void build(const std::string& directory, std::vector<SimilarityMatch>* report = nullptr);
+    // 將一份新提交加入索引，並回傳它與歷史提交中相似的配對
+    std::vector<SimilarityMatch> add(const std::string& path);
+    size_t size() const;
+    size_t commonCount() const; // 已視為樣板、不再比對的指紋數
+};
+
+// commonFingerprints > 0 時在報告最後註明有多少指紋因出現在太多提交中而未列入比對
+void printSimilarityReport(const std::vector<SimilarityMatch>& matches, size_t commonFingerprints = 0);
+void appendSimilarityReport(const std::string& reportPath, const std::vector<SimilarityMatch>& matches);
+
+#endif // SIMILARITY_HPP
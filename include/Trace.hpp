@@ -0,0 +1,55 @@
+// Trace.hpp
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include "Problem.hpp"
+
+// trace.csv 的一筆紀錄：arrivalMs,username,problemTitle,sourcePath,verdict
+// 含有 , 或 " 的欄位以雙引號包住 (內部的 " 寫成 "")
+struct TraceEntry {
+    long long arrivalMs;      // 提交時間 (epoch 毫秒)
+    std::string username;
+    std::string problemTitle;
+    std::string sourcePath;   // 提交當下的程式碼快照
+    Verdict verdict;          // 原始判題結果
+};
+
+// 記錄真實提交：複製一份程式碼快照，並把提交資訊附加到 trace 檔。
+class TraceRecorder {
+private:
+    std::string tracePath;    // e.g., "data/user/trace.csv"
+    std::string sourceDir;    // e.g., "data/user/trace"
+    std::mutex mutex;
+    unsigned long long sequence = 0;
+
+public:
+    TraceRecorder(std::string tracePath, std::string sourceDir);
+    void record(std::chrono::system_clock::time_point arrival,
+                const std::string& username,
+                const std::string& problemTitle,
+                const std::string& codePath,
+                Verdict verdict);
+};
+
+struct ReplayReport {
+    size_t total = 0;         // trace 中的提交數
+    size_t judged = 0;        // 實際重新評測的數量
+    size_t agreed = 0;        // 與原始結果一致的數量
+    size_t skipped = 0;       // 題目或測資已不存在而略過的數量
+    double wallSeconds = 0;
+    double p50Ms = 0, p90Ms = 0, p99Ms = 0, maxMs = 0;
+    std::vector<std::string> mismatches;
+};
+
+std::vector<TraceEntry> loadTrace(const std::string& tracePath);
+
+// 依 trace 的到達時間重播提交。speed 為倍速 (1 = 原速、10 = 十倍速)，0 表示不等待、全速重播。
+ReplayReport replayTrace(ProblemSystem& problemSystem, const std::vector<TraceEntry>& trace, double speed);
+void printReplayReport(const ReplayReport& report);
+
+#endif // TRACE_HPP
@@ -0,0 +1,57 @@
+// Watcher.hpp
+
+#ifndef WATCHER_HPP
+#define WATCHER_HPP
+
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <functional>
+
+// 監看題目清單 (problem.csv) 與各題目的資料夾，有變動時通知 ProblemSystem。
+// Linux 使用 inotify；其他平台退回每秒輪詢檔案的修改時間與大小。
+// 連續的變動會合併 (debounce) 後再通知，避免寫入大量測資時重複重新載入。
+class CatalogWatcher {
+public:
+    using ListDirs = std::function<std::vector<std::string>()>;            // 目前所有題目的 basePath
+    using OnCatalogChange = std::function<void()>;
+    using OnProblemChange = std::function<void(const std::string& basePath)>;
+
+    CatalogWatcher(std::string catalogPath, ListDirs listDirs,
+                   OnCatalogChange onCatalogChange, OnProblemChange onProblemChange);
+    ~CatalogWatcher();
+    CatalogWatcher(const CatalogWatcher&) = delete;
+    CatalogWatcher& operator=(const CatalogWatcher&) = delete;
+
+private:
+    std::string catalogPath;
+    ListDirs listDirs;
+    OnCatalogChange onCatalogChange;
+    OnProblemChange onProblemChange;
+
+    std::atomic<bool> stopping{false};
+    std::thread thread;
+
+    // 尚未通知的變動
+    bool catalogDirty = false;
+    std::set<std::string> dirtyProblems;
+
+#ifdef __linux__
+    int inotifyFd = -1;
+    std::map<int, std::string> watchedDirs;  // watch descriptor -> basePath (題目資料夾或其 testcases)
+    void addWatches();
+    bool readEvents(int timeoutMs);
+#else
+    std::map<std::string, std::string> signatures; // path -> 修改時間與大小的摘要
+    std::string signatureOf(const std::string& path) const;
+    bool pollChanges();
+#endif
+
+    void loop();
+};
+
+#endif // WATCHER_HPP
@@ -0,0 +1,71 @@
+// Workspace.hpp
+
+#ifndef WORKSPACE_HPP
+#define WORKSPACE_HPP
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+// 單次評測使用的檔案位置，同時評測多份程式時必須各自不同。
+struct RunTarget {
+    std::string binaryPath;   // e.g., "/dev/shm/judge-123/ws-0/user_program"
+#ifdef _WIN32
+    // Windows 以檔案重新導向 stdin/stdout；POSIX 直接經由 pipe，不需要這兩個檔案
+    std::string inputPath;    // e.g., "build/workspace/judge-123/ws-0/input.txt"
+    std::string outputPath;   // e.g., "build/workspace/judge-123/ws-0/user_output.txt"
+#endif
+};
+
+class WorkspacePool;
+
+// 借用中的工作區；解構時歸還給 WorkspacePool。
+class WorkspaceLease {
+private:
+    WorkspacePool* pool = nullptr;
+    size_t id = 0;
+    RunTarget runTarget;
+
+public:
+    WorkspaceLease() = default;
+    WorkspaceLease(WorkspacePool* pool, size_t id, RunTarget target);
+    ~WorkspaceLease();
+    WorkspaceLease(WorkspaceLease&& other) noexcept;
+    WorkspaceLease& operator=(WorkspaceLease&& other) noexcept;
+    WorkspaceLease(const WorkspaceLease&) = delete;
+    WorkspaceLease& operator=(const WorkspaceLease&) = delete;
+
+    void release(); // 提前歸還工作區
+    const RunTarget& target() const { return runTarget; }
+};
+
+// 每個評測 worker 的私有工作區 (放執行檔與輸出檔)。
+// Linux 上建立在 tmpfs (/dev/shm)，讓評測過程不必讀寫磁碟；其他平台退回 build/workspace。
+// 工作區用完後只清空內容並放回池中重複使用，不會刪除後再重建。
+class WorkspacePool {
+    friend class WorkspaceLease;
+private:
+    fs::path root;                      // e.g., "/dev/shm/judge-123"
+    std::vector<RunTarget> workspaces;  // 已建立的工作區，index 即為 id
+    std::vector<size_t> freeList;
+    std::mutex mutex;
+
+    WorkspacePool();
+    void release(size_t id);
+
+public:
+    static constexpr long long OUTPUT_LIMIT_BYTES = 64LL * 1024 * 1024; // 單一輸出檔上限
+
+    static WorkspacePool& instance();
+    ~WorkspacePool();
+    WorkspacePool(const WorkspacePool&) = delete;
+    WorkspacePool& operator=(const WorkspacePool&) = delete;
+
+    WorkspaceLease acquire();
+    const fs::path& getRoot() const { return root; }
+};
+
+#endif // WORKSPACE_HPP
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <string>
 #include "Judge.hpp"
+#include "Sandbox.hpp"
 #include "ColorPrint.hpp"
 #include "Utils.hpp"
 
@@ -13,7 +14,47 @@ namespace {
     const std::string version            = "4.4";
 }
 
-int main() {
+// 用法：
+//   judge_system                            互動模式
+//   judge_system --replay <trace> [speed]   重播提交紀錄 (speed: 1、10...，0 表示全速)
+//   judge_system --similarity [dir] [threshold]  檢查程式碼相似度 (預設 data/user/program、0.5)
+//   judge_system --import <archive> <title> [timeLimitMs]  從 .tar/.tar.gz 匯入測資
+int main(int argc, char* argv[]) {
+    // 沙箱 init：由 SandboxPool 在新的 namespace 中重新執行本程式
+    if (argc >= 2 && std::string(argv[1]) == "--sandbox-init") return sandboxInitMain(argc, argv);
+
+    if (argc >= 3 && std::string(argv[1]) == "--replay") {
+        try {
+            JudgeSystem judge(userDataPath, problemDataPath, version);
+            judge.replayProcess(argv[2], argc >= 4 ? std::stod(argv[3]) : 0);
+        } catch (const std::exception& e) {
+            std::cerr << red("[Fatal Error] ") << e.what() << '\n';
+            return 1;
+        }
+        return 0;
+    }
+    if (argc >= 2 && std::string(argv[1]) == "--similarity") {
+        try {
+            JudgeSystem judge(userDataPath, problemDataPath, version);
+            judge.similarityProcess(argc >= 3 ? argv[2] : "data/user/program",
+                                    argc >= 4 ? std::stod(argv[3]) : 0.5);
+        } catch (const std::exception& e) {
+            std::cerr << red("[Fatal Error] ") << e.what() << '\n';
+            return 1;
+        }
+        return 0;
+    }
+
+    if (argc >= 4 && std::string(argv[1]) == "--import") {
+        try {
+            JudgeSystem judge(userDataPath, problemDataPath, version);
+            return judge.importProcess(argv[2], argv[3], argc >= 5 ? std::stoi(argv[4]) : 0) ? 0 : 1;
+        } catch (const std::exception& e) {
+            std::cerr << red("[Fatal Error] ") << e.what() << '\n';
+            return 1;
+        }
+    }
+
     ClearScreen();
 
     try {
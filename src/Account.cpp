@@ -4,6 +4,19 @@
 #include <fstream>
 #include <utility>
 #include <sstream>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#ifdef _WIN32
+    #include <random>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <cerrno>
+#endif
+#ifdef __linux__
+    #include <sys/random.h>
+#endif
 #include "Account.hpp"
 #include "ColorPrint.hpp"
 #include "Utils.hpp"
@@ -11,6 +24,85 @@
 User::User(std::string name, std::string pwd)
     : username(std::move(name)), password(std::move(pwd)) {}
 
+// 固定時間比對密碼：不論在第幾個字元不同，都會掃完整個字串，避免 timing attack。
+bool User::checkPassword(const std::string& input) const {
+    const size_t n = std::max(password.size(), input.size());
+    unsigned char diff = (password.size() != input.size());
+    for (size_t i = 0; i < n; ++i) {
+        unsigned char a = i < password.size() ? password[i] : 0;
+        unsigned char b = i < input.size() ? input[i] : 0;
+        diff |= a ^ b;
+    }
+    return diff == 0;
+}
+
+
+// --- Internal helpers ---
+namespace {
+    // 從作業系統的 CSPRNG 讀取 n 個位元組
+    void fillRandom(unsigned char* buf, size_t n) {
+#ifdef _WIN32
+        // MinGW/MSVC 的 std::random_device 以 rand_s (RtlGenRandom) 實作
+        std::random_device rd;
+        for (size_t i = 0; i < n; ++i) buf[i] = (unsigned char)rd();
+#else
+        size_t got = 0;
+    #ifdef __linux__
+        while (got < n) {
+            ssize_t r = getrandom(buf + got, n - got, 0);
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                break; // 核心不支援 getrandom 時改讀 /dev/urandom
+            }
+            got += (size_t)r;
+        }
+    #endif
+        if (got < n) {
+            int fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+            while (fd >= 0 && got < n) {
+                ssize_t r = read(fd, buf + got, n - got);
+                if (r < 0 && errno == EINTR) continue;
+                if (r <= 0) break;
+                got += (size_t)r;
+            }
+            if (fd >= 0) close(fd);
+        }
+        if (got < n) throw std::runtime_error("Cannot read from the system random source.");
+#endif
+    }
+
+    // 產生 128-bit 的隨機 session token (32 個十六進位字元)
+    std::string generateToken() {
+        static const char* hex = "0123456789abcdef";
+        unsigned char bytes[16];
+        fillRandom(bytes, sizeof(bytes));
+        std::string token(32, '0');
+        for (int i = 0; i < 16; ++i) {
+            token[i * 2] = hex[bytes[i] >> 4];
+            token[i * 2 + 1] = hex[bytes[i] & 0xf];
+        }
+        return token;
+    }
+}
+
+AccountSystem::~AccountSystem() {
+    // 通知背景執行緒結束，並在結束前把尚未寫回的資料寫入檔案。
+    {
+        std::lock_guard<std::mutex> lock(flushMutex);
+        stopping = true;
+    }
+    flushCv.notify_one();
+    if (flusher.joinable()) flusher.join();
+}
+
+AccountSystem::Shard& AccountSystem::shardOf(const std::string& key) {
+    return shards[std::hash<std::string>{}(key) % SHARD_COUNT];
+}
+
+const AccountSystem::Shard& AccountSystem::shardOf(const std::string& key) const {
+    return shards[std::hash<std::string>{}(key) % SHARD_COUNT];
+}
+
 // 透過 std::ifstream 來讀入資料，並將每一行的字串以 , 分隔出使用者名稱與密碼
 void AccountSystem::init(const std::string& userDataPath) {
     AccountSystem::userDataPath = userDataPath;
@@ -24,15 +116,21 @@ void AccountSystem::init(const std::string& userDataPath) {
 
         // 從 userDataPath 載入使用者資料並插入數據
         std::string readLine;
-        userMap.clear(); // 載入前重置 userMap
+        for (auto& shard : shards) { // 載入前重置所有 shard
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            shard.userMap.clear();
+            shard.sessionMap.clear();
+        }
         while (getline(file, readLine)) {
             std::stringstream ss(readLine); // 將字串放進 sstream
             std::string username, password;
             // 以 ',' 分隔字串，取得 username 與 password
             getline(ss, username, ',');
             getline(ss, password);
-            // 將 username 與 password 放入 userMap
-            userMap[username] = User(username, password);
+            // 將 username 與 password 放入對應的 shard
+            Shard& shard = shardOf(username);
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            shard.userMap[username] = User(username, password);
         }
 
         file.close();
@@ -40,6 +138,11 @@ void AccountSystem::init(const std::string& userDataPath) {
     catch (const std::exception& e) {
         std::cerr << "Exception caught: " << e.what() << "\n";
     }
+
+    // 啟動 write-behind 背景執行緒 (只需啟動一次)
+    if (!flusher.joinable()) {
+        flusher = std::thread(&AccountSystem::flushLoop, this);
+    }
 }
 
 // 登入與註冊功能，引導使用者輸入相關資訊完成登入動作。
@@ -58,39 +161,44 @@ std::pair<bool, std::string> AccountSystem::login() {
         }
 
         // 使用者輸入名稱後，查詢使用者是否存在，如果不存在必須提示使用者重新輸入。
-        User* targetUser = search(username);
-        if (targetUser == nullptr) {
+        std::optional<User> targetUser = search(username);
+        if (!targetUser) {
             std::cout << red("User does not exist!\n");
             continue; // 重新輸入
         }
 
         // 使用者名稱存在時，要求使用者輸入密碼。        
         std::cout << green("Welcome back, ") << username << ".\n";
-        if (verifyPassword(targetUser)) {
+        if (verifyPassword(*targetUser)) {
             ClearScreen();
-            // 密碼輸入正確後提示登入成功，並回傳 (true, username)，將 AccountSystem::loginUser 更新。
+            // 密碼輸入正確後提示登入成功，並回傳 (true, username)，為目前使用者建立 session。
             std::cout << yellow("Login Success!!!\n");
-            loginUser = username;
+            logout(loginToken);
+            loginToken = createSession(username);
             return std::make_pair(true, username);
         }
         // 如果密碼輸入失敗，則回到輸入使用者名稱。
     }
 }
 
-// 呼叫時給予使用者名稱作為參數，如果 userList 存在該使用者則回傳其指標，找不到則回傳 nullptr。
-User* AccountSystem::search(const std::string& username) {
-    auto it = userMap.find(username);
-    return (it != userMap.end()) ? &(it->second) : nullptr;
+// 呼叫時給予使用者名稱作為參數，如果存在該使用者則回傳其副本，找不到則回傳 std::nullopt。
+// 回傳副本而非指標，避免其他執行緒修改 map 時指標失效。
+std::optional<User> AccountSystem::search(const std::string& username) const {
+    const Shard& shard = shardOf(username);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.userMap.find(username);
+    if (it == shard.userMap.end()) return std::nullopt;
+    return it->second;
 }
 
 // 驗證使用者密碼，若密碼正確則回傳 true，否則提示使用者重新輸入。
-bool AccountSystem::verifyPassword(User* user) {
+bool AccountSystem::verifyPassword(const User& user) {
     int attempts = 0;
     std::string pwd;
     while (attempts < 3) {
         std::cout << cyan("Please enter your password: ");
         std::cin >> pwd;
-        if (pwd == user->getPassword()) return true; // 密碼正確，回傳 true。
+        if (user.checkPassword(pwd)) return true; // 密碼正確，回傳 true。
         std::cout << red("Password incorrect... please try again.\n"); //  // 密碼錯誤：提示使用者重新輸入。
         attempts++;
     }
@@ -116,8 +224,13 @@ bool AccountSystem::signUp() {
         std::cout << red("Username is reserved. Please choose another name.\n");
         return true;
     }
+    // user.csv 與比賽紀錄都以 ',' 分隔欄位
+    else if (username.find(',') != std::string::npos) {
+        std::cout << red("Username cannot contain ','.\n");
+        return true;
+    }
     // 如果使用者名稱已存在，則提示使用者重新輸入。
-    else if (search(username) != nullptr) {
+    else if (search(username)) {
         std::cout << red("Username already exists. Please try another one.\n");
         return true;
     }
@@ -135,33 +248,109 @@ bool AccountSystem::signUp() {
         std::cout << red("The two passwords do not match. Please try again.\n");
     }
 
+    // 在輸入密碼期間可能已有其他人註冊同名帳號，由 registerUser 做最後的檢查。
+    if (!registerUser(username, pwd2)) {
+        std::cout << red("Username already exists. Please try another one.\n");
+        return true;
+    }
     std::cout << yellow("Sign-up success! Please login now.\n\n");
-    addUser(username, pwd2); // 更新使用者資訊。
     return false; // 註冊成功。
 }
 
-// 將解析出來的 username 與 password 放入 AccountSystem 的 member userList。
+// 將解析出來的 username 與 password 放入對應的 shard (已存在則覆蓋)。
 void AccountSystem::addUser(const std::string& username, const std::string& password) {
-    userMap[username] = User(username, password);
-    userDataUpdate(); // 呼叫 AccountSystem
+    {
+        Shard& shard = shardOf(username);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.userMap[username] = User(username, password);
+    }
+    userDataUpdate(); // 通知背景執行緒寫回檔案
+}
+
+// 只有在使用者不存在時才新增，檢查與插入在同一把鎖內完成。名稱含有 ',' 時不接受。
+bool AccountSystem::registerUser(const std::string& username, const std::string& password) {
+    if (username.empty() || username.find(',') != std::string::npos) return false;
+    {
+        Shard& shard = shardOf(username);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        if (!shard.userMap.emplace(username, User(username, password)).second) return false;
+    }
+    userDataUpdate();
+    return true;
+}
+
+// 非互動式登入：密碼正確則建立 session 並回傳 token，否則回傳空字串。
+std::string AccountSystem::authenticate(const std::string& username, const std::string& password) {
+    std::optional<User> user = search(username);
+    if (!user || !user->checkPassword(password)) return "";
+    return createSession(username);
+}
+
+// 為使用者建立新的 session，並回傳其 token。
+std::string AccountSystem::createSession(const std::string& username) {
+    std::string token = generateToken();
+    Shard& shard = shardOf(token);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.sessionMap[token] = username;
+    return token;
+}
+
+// 由 token 查詢 session 所屬的使用者名稱。
+std::string AccountSystem::sessionUser(const std::string& token) const {
+    if (token.empty()) return "";
+    const Shard& shard = shardOf(token);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.sessionMap.find(token);
+    return (it != shard.sessionMap.end()) ? it->second : "";
+}
+
+void AccountSystem::logout(const std::string& token) {
+    if (token.empty()) return;
+    Shard& shard = shardOf(token);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.sessionMap.erase(token);
 }
 
-// 將所有存在 userList 的資料重新覆蓋 (寫入) userDataPath。
+// 標記資料需要寫回，實際寫檔交給 flushLoop，呼叫端不必等待磁碟 I/O。
 void AccountSystem::userDataUpdate() {
-    try {
-        std::ofstream outputFile(AccountSystem::userDataPath);
-        if( !outputFile ) {
-            throw std::runtime_error("Error: File does not exist - " + userDataPath);
-        }
+    {
+        std::lock_guard<std::mutex> lock(flushMutex);
+        dirty = true;
+    }
+    flushCv.notify_one();
+}
+
+// write-behind 背景執行緒：有資料變動時，將所有 shard 的使用者覆蓋 (寫入) userDataPath。
+// 先寫到暫存檔再 rename，避免寫到一半時程式中止造成檔案毀損。
+void AccountSystem::flushLoop() {
+    std::unique_lock<std::mutex> flushLock(flushMutex);
+    while (true) {
+        flushCv.wait(flushLock, [this] { return dirty || stopping; });
+        if (!dirty && stopping) return;
+        dirty = false;
+        flushLock.unlock();
 
-        // 遍歷 userList ，透過 outputFile 寫入 userDataPath。
-        // 需要 class User 的 getter 才能取得 Username 和 Password。
-        for (const auto& pair : userMap) { // 遍歷 userList 裡的每個 User
-            outputFile << pair.second.getUsername() << "," << pair.second.getPassword() << "\n"; // 將 user 寫入檔案
+        try {
+            const std::string tmpPath = userDataPath + ".tmp";
+            std::ofstream outputFile(tmpPath);
+            if( !outputFile ) {
+                throw std::runtime_error("Error: Cannot write file - " + tmpPath);
+            }
+
+            // 逐一取得每個 shard 的讀鎖，透過 outputFile 寫入。
+            for (const auto& shard : shards) {
+                std::shared_lock<std::shared_mutex> lock(shard.mutex);
+                for (const auto& pair : shard.userMap) {
+                    outputFile << pair.second.getUsername() << "," << pair.second.getPassword() << "\n";
+                }
+            }
+            outputFile.close();
+            std::filesystem::rename(tmpPath, userDataPath);
         }
-        outputFile.close();
-    }
-    catch (const std::exception& e) {
-        std::cerr << "Exception caught: " << e.what() << "\n";
+        catch (const std::exception& e) {
+            std::cerr << "Exception caught: " << e.what() << "\n";
+        }
+
+        flushLock.lock();
     }
 }
\ No newline at end of file
@@ -0,0 +1,473 @@
+// AsyncIo.cpp
+
+#include "AsyncIo.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <memory>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define JUDGE_HAS_IO_URING 1
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+// --- Internal helpers ---
+namespace {
+    std::string readFileBlocking(const fs::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream ss;
+        ss << file.rdbuf();
+        return ss.str();
+    }
+
+#ifdef JUDGE_HAS_IO_URING
+    constexpr unsigned RING_ENTRIES = 64;
+    constexpr size_t PIPE_BUFFER_SIZE = 64 * 1024;  // 每個 ring 註冊一塊固定的讀取緩衝區
+
+    // 最小化的 io_uring 包裝：一個執行緒一個 ring，只在該執行緒使用，因此不需要鎖。
+    // 需要 IORING_FEAT_EXT_ARG (Linux 5.11+) 才能在等待完成事件時帶逾時；不支援就視為無法使用。
+    class IoRing {
+    private:
+        int fd = -1;
+        void* sqRing = MAP_FAILED;
+        void* cqRing = MAP_FAILED;
+        io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+        size_t sqRingSize = 0, cqRingSize = 0, sqesSize = 0;
+
+        unsigned* sqHead = nullptr;
+        unsigned* sqTail = nullptr;
+        unsigned* sqMask = nullptr;
+        unsigned* sqArray = nullptr;
+        unsigned sqEntries = 0;
+        unsigned sqLocalTail = 0;   // 已填好但尚未送出的 SQE 也算在內
+        unsigned toSubmit = 0;
+
+        unsigned* cqHead = nullptr;
+        unsigned* cqTail = nullptr;
+        unsigned* cqMask = nullptr;
+        io_uring_cqe* cqes = nullptr;
+
+        std::unique_ptr<char[]> fixedBuffer;
+        bool bufferRegistered = false;
+
+        template <typename T>
+        static T* at(void* base, unsigned offset) {
+            return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+        }
+
+    public:
+        IoRing() {
+            io_uring_params params{};
+            fd = (int)syscall(__NR_io_uring_setup, RING_ENTRIES, &params);
+            if (fd < 0) return;
+            if (!(params.features & IORING_FEAT_EXT_ARG)) {
+                close(fd);
+                fd = -1;
+                return;
+            }
+
+            sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            if (params.features & IORING_FEAT_SINGLE_MMAP) sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+
+            sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+            if (sqRing == MAP_FAILED) return;
+            if (params.features & IORING_FEAT_SINGLE_MMAP) {
+                cqRing = sqRing;
+            } else {
+                cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+                if (cqRing == MAP_FAILED) return;
+            }
+            sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+            sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE,
+                                                   MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+            if (sqes == MAP_FAILED) return;
+
+            sqHead = at<unsigned>(sqRing, params.sq_off.head);
+            sqTail = at<unsigned>(sqRing, params.sq_off.tail);
+            sqMask = at<unsigned>(sqRing, params.sq_off.ring_mask);
+            sqArray = at<unsigned>(sqRing, params.sq_off.array);
+            sqEntries = params.sq_entries;
+            sqLocalTail = *sqTail;
+
+            cqHead = at<unsigned>(cqRing, params.cq_off.head);
+            cqTail = at<unsigned>(cqRing, params.cq_off.tail);
+            cqMask = at<unsigned>(cqRing, params.cq_off.ring_mask);
+            cqes = at<io_uring_cqe>(cqRing, params.cq_off.cqes);
+
+            // 讀取 pipe 用的緩衝區先向核心註冊，之後以 READ_FIXED 讀取時不必每次重新對應記憶體頁
+            fixedBuffer.reset(new char[PIPE_BUFFER_SIZE]);
+            iovec iov{fixedBuffer.get(), PIPE_BUFFER_SIZE};
+            bufferRegistered = syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS, &iov, 1) == 0;
+        }
+
+        ~IoRing() {
+            if (sqes != MAP_FAILED) munmap(sqes, sqesSize);
+            if (cqRing != MAP_FAILED && cqRing != sqRing) munmap(cqRing, cqRingSize);
+            if (sqRing != MAP_FAILED) munmap(sqRing, sqRingSize);
+            if (fd >= 0) close(fd);
+        }
+
+        IoRing(const IoRing&) = delete;
+        IoRing& operator=(const IoRing&) = delete;
+
+        bool ok() const { return fd >= 0 && sqes != MAP_FAILED && cqes != nullptr; }
+        char* buffer() { return fixedBuffer.get(); }
+        bool hasFixedBuffer() const { return bufferRegistered; }
+
+        // 取得一個空的 SQE；佇列已滿時回傳 nullptr
+        io_uring_sqe* getSqe() {
+            unsigned head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+            if (sqLocalTail - head >= sqEntries) return nullptr;
+            unsigned index = sqLocalTail & *sqMask;
+            io_uring_sqe* sqe = &sqes[index];
+            std::memset(sqe, 0, sizeof(*sqe));
+            sqArray[index] = index;
+            sqLocalTail++;
+            toSubmit++;
+            return sqe;
+        }
+
+        // 只送出待送的 SQE，不等待完成；讓核心取走 SQE 以空出佇列
+        bool submit() {
+            __atomic_store_n(sqTail, sqLocalTail, __ATOMIC_RELEASE);
+            while (toSubmit > 0) {
+                int ret = (int)syscall(__NR_io_uring_enter, fd, toSubmit, 0, 0, nullptr, 0);
+                if (ret > 0) {
+                    toSubmit -= std::min<unsigned>(toSubmit, (unsigned)ret);
+                    continue;
+                }
+                if (ret < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY)) continue;
+                return false;
+            }
+            return true;
+        }
+
+        // 送出所有待送的 SQE，並等待至少一個完成事件或到達 deadline。
+        // 回傳 false 代表逾時或發生錯誤。
+        bool submitAndWait(std::chrono::steady_clock::time_point deadline) {
+            __atomic_store_n(sqTail, sqLocalTail, __ATOMIC_RELEASE);
+
+            auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (remaining < 0) remaining = 0;
+            __kernel_timespec ts{};
+            ts.tv_sec = remaining / 1000000000LL;
+            ts.tv_nsec = remaining % 1000000000LL;
+            io_uring_getevents_arg arg{};
+            arg.ts = reinterpret_cast<__u64>(&ts);
+
+            while (true) {
+                int ret = (int)syscall(__NR_io_uring_enter, fd, toSubmit, 1,
+                                       IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+                if (ret >= 0) {
+                    toSubmit -= std::min<unsigned>(toSubmit, (unsigned)ret);
+                    // 逾時與完成可能同時發生，只要有完成事件就照常處理
+                    return true;
+                }
+                if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+                return errno != ETIME ? false : hasCompletion();
+            }
+        }
+
+        bool hasCompletion() const {
+            return *cqHead != __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        }
+
+        // 依序處理所有已完成的事件
+        template <typename Fn>
+        void reap(Fn&& handle) {
+            unsigned head = *cqHead;
+            unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head) {
+                const io_uring_cqe& cqe = cqes[head & *cqMask];
+                handle(cqe.user_data, cqe.res);
+            }
+            __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+        }
+    };
+
+    // 每個執行緒第一次使用時建立自己的 ring，之後重複使用；建立失敗則為 nullptr。
+    std::unique_ptr<IoRing>& threadRingSlot() {
+        thread_local std::unique_ptr<IoRing> ring = [] {
+            auto created = std::make_unique<IoRing>();
+            return created->ok() ? std::move(created) : nullptr;
+        }();
+        return ring;
+    }
+
+    IoRing* threadRing() {
+        return threadRingSlot().get();
+    }
+
+    // io_uring_enter 本身失敗時不再使用這個 ring：關閉它 (核心會取消其上所有請求)，此執行緒之後改走 fallback。
+    void dropRing() {
+        threadRingSlot().reset();
+    }
+
+    // 取得一個空的 SQE；佇列已滿時先送出待送的 SQE 再試一次，仍失敗時回傳 nullptr
+    io_uring_sqe* acquireSqe(IoRing& ring) {
+        io_uring_sqe* sqe = ring.getSqe();
+        if (!sqe && ring.submit()) sqe = ring.getSqe();
+        return sqe;
+    }
+
+    void prepRw(io_uring_sqe* sqe, __u8 opcode, int fd, const void* addr, unsigned len, __u64 offset, __u64 userData) {
+        sqe->opcode = opcode;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<__u64>(addr);
+        sqe->len = len;
+        sqe->off = offset;
+        sqe->user_data = userData;
+    }
+
+    // 取消尚未完成的請求並等它們全部回報完成事件。之後請求用到的緩衝區才能釋放，
+    // 重用 ring 時也不會收到過期的完成事件。取消後的請求一定會完成，因此不設時限。
+    // 被取消的請求可能已完成一部分，它們的完成事件交給 onComplete 處理。
+    // 回傳 false 代表 io_uring_enter 本身發生錯誤，呼叫端應以 dropRing() 捨棄這個 ring。
+    template <typename Fn>
+    bool cancelAndDrain(IoRing& ring, std::vector<__u64>& pending, Fn&& onComplete) {
+        constexpr __u64 CANCEL_TAG = ~0ULL;
+        size_t cancels = 0;  // 取消請求本身也會產生完成事件，同樣要收完
+        for (__u64 userData : pending) {
+            io_uring_sqe* sqe = acquireSqe(ring);
+            if (!sqe) return false;
+            prepRw(sqe, IORING_OP_ASYNC_CANCEL, -1, nullptr, 0, 0, CANCEL_TAG);
+            sqe->addr = userData;
+            cancels++;
+        }
+        while (!pending.empty() || cancels > 0) {
+            if (!ring.submitAndWait(std::chrono::steady_clock::now() + std::chrono::seconds(1)) && !ring.hasCompletion()) {
+                if (errno == ETIME) continue;
+                return false;
+            }
+            ring.reap([&](__u64 userData, int res) {
+                if (userData == CANCEL_TAG) {
+                    cancels--;
+                    return;
+                }
+                pending.erase(std::remove(pending.begin(), pending.end(), userData), pending.end());
+                onComplete(userData, res);
+            });
+        }
+        return true;
+    }
+#endif
+
+#ifndef _WIN32
+    // 無法使用 io_uring 時的版本：非阻塞 fd + poll()。
+    // written 與 result 為已完成的部分 (io_uring 中途失敗時從該處接續)。
+    PipeResult pumpPipesPoll(int inFd, int outFd, const std::string& input, size_t written, PipeResult result,
+                             size_t outputLimit, std::chrono::steady_clock::time_point deadline) {
+        if (inFd >= 0) fcntl(inFd, F_SETFL, fcntl(inFd, F_GETFL) | O_NONBLOCK);
+        fcntl(outFd, F_SETFL, fcntl(outFd, F_GETFL) | O_NONBLOCK);
+
+        if (inFd >= 0 && written >= input.size()) { close(inFd); inFd = -1; }
+        char buffer[64 * 1024];
+
+        while (outFd >= 0) {
+            pollfd fds[2];
+            nfds_t count = 0;
+            fds[count++] = {outFd, POLLIN, 0};
+            if (inFd >= 0) fds[count++] = {inFd, POLLOUT, 0};
+
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0) { result.timedOut = true; break; }
+            int ready = poll(fds, count, (int)std::min<long long>(remaining, 1000));
+            if (ready < 0 && errno != EINTR) break;
+            if (ready <= 0) continue;
+
+            if (count == 2 && fds[1].revents) {
+                ssize_t n = write(inFd, input.data() + written, input.size() - written);
+                if (n > 0) written += n;
+                if ((n < 0 && errno != EAGAIN) || written == input.size()) { close(inFd); inFd = -1; }
+            }
+            if (fds[0].revents) {
+                ssize_t n = read(outFd, buffer, sizeof(buffer));
+                if (n > 0) {
+                    result.output.append(buffer, n);
+                    if (result.output.size() > outputLimit) { result.overflow = true; break; }
+                } else if (n == 0 || errno != EAGAIN) {
+                    close(outFd);
+                    outFd = -1;
+                }
+            }
+        }
+        if (inFd >= 0) close(inFd);
+        if (outFd >= 0) close(outFd);
+        return result;
+    }
+#endif
+}
+
+bool asyncIoAvailable() {
+#ifdef JUDGE_HAS_IO_URING
+    return threadRing() != nullptr;
+#else
+    return false;
+#endif
+}
+
+// 一次送出所有檔案的讀取請求 (數量超過 ring 大小時分批)，讀不完整的部分從中斷處繼續送出。
+std::vector<std::string> readFiles(const std::vector<fs::path>& paths) {
+    std::vector<std::string> contents(paths.size());
+#ifdef JUDGE_HAS_IO_URING
+    IoRing* ring = threadRing();
+    if (ring) {
+        std::vector<int> fds(paths.size(), -1);
+        std::vector<size_t> done(paths.size(), 0);
+        std::vector<char> busy(paths.size(), 0); // 讀取請求在途中的檔案
+        std::vector<size_t> queue;  // 還需要送出讀取請求的檔案
+        for (size_t i = 0; i < paths.size(); ++i) {
+            fds[i] = open(paths[i].c_str(), O_RDONLY | O_CLOEXEC);
+            struct stat st{};
+            if (fds[i] < 0 || fstat(fds[i], &st) != 0) continue;
+            contents[i].resize((size_t)st.st_size);
+            if (st.st_size > 0) queue.push_back(i);
+        }
+
+        size_t inflight = 0;
+        bool failed = false;
+        while (!failed && (!queue.empty() || inflight > 0)) {
+            while (!queue.empty()) {
+                io_uring_sqe* sqe = ring->getSqe();
+                if (!sqe) break;
+                size_t i = queue.back();
+                queue.pop_back();
+                size_t remaining = contents[i].size() - done[i];
+                prepRw(sqe, IORING_OP_READ, fds[i], &contents[i][done[i]],
+                       (unsigned)std::min<size_t>(remaining, 1u << 30), done[i], i);
+                busy[i] = 1;
+                inflight++;
+            }
+            if (!ring->submitAndWait(std::chrono::steady_clock::now() + std::chrono::seconds(10))
+                && !ring->hasCompletion()) {
+                failed = true;
+                break;
+            }
+            ring->reap([&](__u64 userData, int res) {
+                size_t i = (size_t)userData;
+                busy[i] = 0;
+                inflight--;
+                if (res <= 0) {
+                    contents[i].resize(done[i]); // 檔案在讀取期間變短
+                    return;
+                }
+                done[i] += (size_t)res;
+                if (done[i] < contents[i].size()) queue.push_back(i);
+            });
+        }
+        if (failed && inflight > 0) {
+            // 讀取請求仍在途中：先取消並等它們結束，緩衝區才能釋放，之後改用一般讀檔重來
+            std::vector<__u64> pending;
+            for (size_t i = 0; i < paths.size(); ++i) {
+                if (busy[i]) pending.push_back(i);
+            }
+            if (!cancelAndDrain(*ring, pending, [](__u64, int) {})) dropRing();
+        }
+        for (int fd : fds) {
+            if (fd >= 0) close(fd);
+        }
+        if (!failed) return contents;
+    }
+#endif
+    for (size_t i = 0; i < paths.size(); ++i) contents[i] = readFileBlocking(paths[i]);
+    return contents;
+}
+
+#ifndef _WIN32
+// 以 io_uring 同時處理寫入 stdin 與讀取 stdout：兩個方向各自最多一個請求在途，
+// 每次 io_uring_enter 同時送出新請求並等待完成，整個評測只需少量系統呼叫。
+PipeResult pumpPipes(int inFd, int outFd, const std::string& input, size_t outputLimit,
+                     std::chrono::steady_clock::time_point deadline) {
+#ifdef JUDGE_HAS_IO_URING
+    IoRing* ring = threadRing();
+    if (ring && ring->hasFixedBuffer()) {
+        enum : __u64 { WRITE_TAG = 1, READ_TAG = 2 };
+        PipeResult result;
+        size_t written = 0;
+        bool writing = false, reading = false, eof = false, ringFailed = false;
+        if (input.empty()) { close(inFd); inFd = -1; }
+
+        auto complete = [&](__u64 userData, int res) {
+            if (res == -ECANCELED) {         // 被取消的請求沒有搬移任何資料
+                (userData == WRITE_TAG ? writing : reading) = false;
+                return;
+            }
+            if (userData == WRITE_TAG) {
+                writing = false;
+                if (res > 0) written += (size_t)res;
+                // 受測程式不讀完輸入就結束時會收到 EPIPE，不算錯誤
+                if (inFd >= 0 && (res <= 0 || written == input.size())) { close(inFd); inFd = -1; }
+            } else if (userData == READ_TAG) {
+                reading = false;
+                if (res <= 0) { eof = true; return; }
+                result.output.append(ring->buffer(), (size_t)res);
+                if (result.output.size() > outputLimit) result.overflow = true;
+            }
+        };
+
+        while (!eof) {
+            if (inFd >= 0 && !writing) {
+                io_uring_sqe* sqe = acquireSqe(*ring);
+                if (!sqe) { ringFailed = true; break; }
+                prepRw(sqe, IORING_OP_WRITE, inFd, input.data() + written,
+                       (unsigned)std::min<size_t>(input.size() - written, 1u << 20), 0, WRITE_TAG);
+                writing = true;
+            }
+            if (!reading) {
+                io_uring_sqe* sqe = acquireSqe(*ring);
+                if (!sqe) { ringFailed = true; break; }
+                prepRw(sqe, IORING_OP_READ_FIXED, outFd, ring->buffer(), (unsigned)PIPE_BUFFER_SIZE, 0, READ_TAG);
+                sqe->buf_index = 0;
+                reading = true;
+            }
+            if (!ring->submitAndWait(deadline)) {
+                if (errno != ETIME) { ringFailed = true; break; }
+                result.timedOut = true;
+                break;
+            }
+            ring->reap(complete);
+            if (result.overflow) break;
+        }
+
+        std::vector<__u64> pending;
+        if (writing) pending.push_back(WRITE_TAG);
+        if (reading) pending.push_back(READ_TAG);
+        if (!pending.empty() && !cancelAndDrain(*ring, pending, complete)) {
+            // 在途請求的結果無從得知，不能從中斷處接續 (可能重送輸入或漏掉輸出)
+            dropRing();
+            result.ioError = true;
+            if (inFd >= 0) close(inFd);
+            close(outFd);
+            return result;
+        }
+        if (ringFailed && !result.overflow) {
+            // ring 無法繼續使用：請求都已結束，從目前的進度改用 poll() 接續
+            dropRing();
+            return pumpPipesPoll(inFd, outFd, input, written, std::move(result), outputLimit, deadline);
+        }
+        if (inFd >= 0) close(inFd);
+        close(outFd);
+        return result;
+    }
+#endif
+    return pumpPipesPoll(inFd, outFd, input, 0, PipeResult{}, outputLimit, deadline);
+}
+#endif
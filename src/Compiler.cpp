@@ -0,0 +1,398 @@
+// Compiler.cpp
+
+#include "Compiler.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cstdint>
+#include <cerrno>
+#include <filesystem>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <process.h>
+#define BINARY_EXT ".exe"
+#define getProcessId _getpid
+#else
+#include <fcntl.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#define BINARY_EXT ""
+#define getProcessId getpid
+extern char** environ;
+#endif
+
+namespace fs = std::filesystem;
+
+// --- Internal helpers ---
+namespace {
+    // 會預先編譯的標頭；提交的第一個 #include 必須是其中之一才能使用 PCH。
+    const std::vector<std::string> pchHeaders = {"bits/stdc++.h", "iostream"};
+
+    const std::string pchRoot   = "build/pch";
+    const std::string cacheRoot = "build/cache";
+
+    // g++ 加上 profile 的參數 (以空白分隔)
+    std::vector<std::string> compilerArgs(const CompileProfile& profile) {
+        std::vector<std::string> args = {"g++"};
+        std::istringstream flags(profile.flags);
+        for (std::string flag; flags >> flag; ) args.push_back(flag);
+        return args;
+    }
+
+    // 執行 g++ 並等待結束，stdoutPath / stderrPath 非空時把該輸出導向檔案。
+    // POSIX：以 posix_spawnp 直接傳入參數陣列，不經過 shell，路徑中的引號、; 等字元都只是檔名的一部分。
+    // Windows：檔名不能含有 "，以雙引號包住每個參數後交給 system()。
+    bool runCompiler(const std::vector<std::string>& args,
+                     const std::string& stdoutPath = "", const std::string& stderrPath = "") {
+#ifdef _WIN32
+        std::string cmd = args[0];
+        for (size_t i = 1; i < args.size(); ++i) cmd += " \"" + args[i] + "\"";
+        if (!stdoutPath.empty()) cmd += " > \"" + stdoutPath + "\"";
+        if (!stderrPath.empty()) cmd += " 2> \"" + stderrPath + "\"";
+        return system(cmd.c_str()) == 0;
+#else
+        std::vector<char*> argv;
+        for (const auto& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+        argv.push_back(nullptr);
+
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        if (!stdoutPath.empty()) {
+            posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, stdoutPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        }
+        if (!stderrPath.empty()) {
+            posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, stderrPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        }
+        pid_t pid = -1;
+        int err = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+        posix_spawn_file_actions_destroy(&actions);
+        if (err != 0) return false;
+
+        int status = 0;
+        while (waitpid(pid, &status, 0) < 0) {
+            if (errno != EINTR) return false;
+        }
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif
+    }
+
+    std::string readFile(const std::string& path, bool& ok) {
+        std::ifstream file(path, std::ios::binary);
+        ok = (bool)file;
+        std::stringstream ss;
+        ss << file.rdbuf();
+        return ss.str();
+    }
+
+    // SHA-256 (FIPS 180-4)。快取 key 由提交者控制的原始碼決定，必須使用抗碰撞的雜湊，
+    // 否則可以刻意構造碰撞，讓別人的提交拿到自己的執行檔。
+    class Sha256 {
+    public:
+        void update(const std::string& data) {
+            for (unsigned char c : data) {
+                block[blockLen++] = c;
+                if (blockLen == 64) {
+                    transform();
+                    blockLen = 0;
+                }
+            }
+            bitLen += (uint64_t)data.size() * 8;
+        }
+
+        std::string hexDigest() {
+            uint64_t totalBits = bitLen;
+            block[blockLen++] = 0x80;
+            if (blockLen > 56) {
+                while (blockLen < 64) block[blockLen++] = 0;
+                transform();
+                blockLen = 0;
+            }
+            while (blockLen < 56) block[blockLen++] = 0;
+            for (int i = 7; i >= 0; --i) block[blockLen++] = (unsigned char)(totalBits >> (i * 8));
+            transform();
+
+            static const char* hex = "0123456789abcdef";
+            std::string out;
+            for (uint32_t v : state) {
+                for (int i = 28; i >= 0; i -= 4) out += hex[(v >> i) & 0xf];
+            }
+            return out;
+        }
+
+    private:
+        uint32_t state[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                             0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+        unsigned char block[64];
+        size_t blockLen = 0;
+        uint64_t bitLen = 0;
+
+        static uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+        void transform() {
+            static const uint32_t k[64] = {
+                0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+                0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+                0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+                0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+                0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+                0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+                0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+                0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+            uint32_t w[64];
+            for (int i = 0; i < 16; ++i) {
+                w[i] = (uint32_t)block[i * 4] << 24 | (uint32_t)block[i * 4 + 1] << 16
+                     | (uint32_t)block[i * 4 + 2] << 8 | (uint32_t)block[i * 4 + 3];
+            }
+            for (int i = 16; i < 64; ++i) {
+                uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+                uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+                w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+            }
+            uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+            uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+            for (int i = 0; i < 64; ++i) {
+                uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+                uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+                h = g; g = f; f = e; e = d + t1;
+                d = c; c = b; b = a; a = t1 + t2;
+            }
+            state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+            state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+        }
+    };
+
+    // 快取大小上限 (JUDGE_CACHE_MB，預設 256 MB)
+    uintmax_t cacheLimitBytes() {
+        const char* env = std::getenv("JUDGE_CACHE_MB");
+        long long mb = env ? std::atoll(env) : 0;
+        return (uintmax_t)(mb > 0 ? mb : 256) * 1024 * 1024;
+    }
+
+    // 找出原始碼中第一個前置處理指令；若是 #include <X> (或 "X") 則回傳 X，否則回傳空字串。
+    // 只略過空白行與註解，遇到其他程式碼或指令就停止，和 g++ 使用 PCH 的條件一致。
+    std::string firstInclude(const std::string& source) {
+        std::istringstream in(source);
+        std::string line;
+        bool inBlockComment = false;
+        while (std::getline(in, line)) {
+            size_t pos = 0;
+            while (true) {
+                if (inBlockComment) {
+                    size_t end = line.find("*/", pos);
+                    if (end == std::string::npos) { pos = line.size(); break; }
+                    pos = end + 2;
+                    inBlockComment = false;
+                }
+                pos = line.find_first_not_of(" \t\r", pos);
+                if (pos == std::string::npos) { pos = line.size(); break; }
+                if (line.compare(pos, 2, "/*") == 0) { inBlockComment = true; pos += 2; continue; }
+                break;
+            }
+            if (pos >= line.size() || line.compare(pos, 2, "//") == 0) continue;
+            if (line[pos] != '#') return "";
+
+            pos = line.find_first_not_of(" \t", pos + 1);
+            if (pos == std::string::npos || line.compare(pos, 7, "include") != 0) return "";
+            pos = line.find_first_not_of(" \t", pos + 7);
+            if (pos == std::string::npos || (line[pos] != '<' && line[pos] != '"')) return "";
+            char close = (line[pos] == '<') ? '>' : '"';
+            size_t end = line.find(close, pos + 1);
+            if (end == std::string::npos) return "";
+            return line.substr(pos + 1, end - pos - 1);
+        }
+        return "";
+    }
+
+    bool isPchHeader(const std::string& header) {
+        for (const auto& h : pchHeaders) {
+            if (h == header) return true;
+        }
+        return false;
+    }
+
+    // 以暫存檔 + rename 複製，避免其他執行緒讀到寫到一半的檔案。
+    bool atomicCopy(const fs::path& from, const fs::path& to, const std::string& tmpSuffix) {
+        std::error_code ec;
+        fs::path tmp = to;
+        tmp += ".tmp-" + tmpSuffix;
+        if (!fs::copy_file(from, tmp, fs::copy_options::overwrite_existing, ec)) return false;
+        fs::rename(tmp, to, ec);
+        if (ec) fs::remove(tmp, ec);
+        return !ec;
+    }
+}
+
+const CompileProfile& defaultProfile() {
+    static const CompileProfile profile{"default", ""};
+    return profile;
+}
+
+CompileService& CompileService::instance() {
+    static CompileService service;
+    return service;
+}
+
+CompileService::~CompileService() {
+    for (auto& builder : builders) {
+        if (builder.joinable()) builder.join();
+    }
+}
+
+// 取得 g++ 版本 (只查詢一次)，作為 PCH 與快取是否仍然有效的依據。
+const std::string& CompileService::getCompilerVersion() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (compilerVersion.empty()) {
+        std::error_code ec;
+        fs::create_directories(pchRoot, ec);
+        const std::string versionFile = pchRoot + "/compiler_version.txt";
+        bool ok = runCompiler({"g++", "-dumpfullversion"}, fs::path(versionFile).make_preferred().string());
+        std::string version = ok ? readFile(versionFile, ok) : "";
+        while (!version.empty() && (version.back() == '\n' || version.back() == '\r')) version.pop_back();
+        compilerVersion = version.empty() ? "unknown" : version;
+    }
+    return compilerVersion;
+}
+
+void CompileService::warmUp(const CompileProfile& profile) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pchStates.count(profile.name)) return;
+    auto state = std::make_shared<PchState>();
+    pchStates[profile.name] = state;
+    builders.emplace_back(&CompileService::buildPch, this, profile, state);
+}
+
+bool CompileService::pchReady(const CompileProfile& profile) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = pchStates.find(profile.name);
+    return it != pchStates.end() && it->second->ready;
+}
+
+// 為每個標頭建立一個只含 #include_next 的包裝檔，並把它編譯成同名的 .gch。
+// 編譯提交時加上 -I build/pch/<profile>：g++ 會先找到 .gch；若參數不符而無法使用，
+// 則讀取包裝檔並透過 #include_next 回到系統標頭，結果與未使用 PCH 時相同。
+void CompileService::buildPch(const CompileProfile& profile, std::shared_ptr<PchState> state) {
+    const std::string& version = getCompilerVersion();
+    const fs::path dir = fs::path(pchRoot) / profile.name;
+    const fs::path stampPath = dir / "stamp.txt";
+    const std::string stamp = version + "\n" + profile.flags + "\n";
+
+    bool stampOk = false;
+    bool upToDate = (readFile(stampPath.string(), stampOk) == stamp) && stampOk;
+
+    bool built = true;
+    for (const auto& header : pchHeaders) {
+        fs::path wrapper = dir / header;
+        fs::path gch = wrapper;
+        gch += ".gch";
+
+        std::error_code ec;
+        if (upToDate && fs::exists(gch, ec)) continue;
+
+        fs::create_directories(wrapper.parent_path(), ec);
+        std::ofstream(wrapper) << "#include_next <" << header << ">\n";
+
+        // 暫存檔帶上 pid，多個判題程序同時建立同一份 PCH 時不會互相覆寫
+        fs::path tmp = gch;
+        tmp += ".tmp-" + std::to_string(getProcessId());
+        fs::path log = dir / "pch_build.log";
+        std::vector<std::string> args = compilerArgs(profile);
+        args.insert(args.end(), {"-x", "c++-header", wrapper.make_preferred().string(),
+                                 "-o", tmp.make_preferred().string()});
+        if (runCompiler(args, "", log.make_preferred().string())) {
+            fs::rename(tmp, gch, ec);
+            if (ec) built = false;
+        } else {
+            fs::remove(tmp, ec);
+            built = false;
+        }
+    }
+
+    if (built) std::ofstream(stampPath) << stamp;
+    state->ready = built;
+}
+
+bool CompileService::compile(const std::string& codePath, const std::string& binaryPath,
+                             const CompileProfile& profile) {
+    bool readOk = false;
+    const std::string source = readFile(codePath, readOk);
+    const std::string binary = fs::path(binaryPath).make_preferred().string();
+
+    // 快取命中：直接複製先前編譯好的執行檔。
+    fs::path cached;
+    if (readOk) {
+        // 各欄位以 '\0' 分隔，避免不同的 (參數, 版本, 原始碼) 組合串接後相同
+        Sha256 sha;
+        sha.update(profile.flags);
+        sha.update(std::string(1, '\0'));
+        sha.update(getCompilerVersion());
+        sha.update(std::string(1, '\0'));
+        sha.update(source);
+        cached = fs::path(cacheRoot) / (sha.hexDigest() + BINARY_EXT);
+
+        std::error_code ec;
+        if (fs::exists(cached, ec) && atomicCopy(cached, binaryPath, fs::path(binaryPath).filename().string())) {
+            fs::last_write_time(cached, fs::file_time_type::clock::now(), ec); // 記錄最近使用，供淘汰時參考
+            return true;
+        }
+    }
+
+    std::vector<std::string> args = compilerArgs(profile);
+    if (readOk && isPchHeader(firstInclude(source)) && pchReady(profile)) {
+        args.insert(args.end(), {"-I", (fs::path(pchRoot) / profile.name).make_preferred().string()});
+    }
+    // 以 - 開頭的檔名會被 g++ 當成參數 (例如 -fplugin=...)，一律加上目錄
+    const std::string sourceArg = (!codePath.empty() && codePath[0] == '-') ? "./" + codePath : codePath;
+    args.insert(args.end(), {sourceArg, "-o", binary});
+    if (!runCompiler(args)) return false;
+
+    if (!cached.empty()) {
+        std::error_code ec;
+        fs::create_directories(cacheRoot, ec);
+        if (atomicCopy(binaryPath, cached, fs::path(binaryPath).filename().string())) {
+            uintmax_t size = fs::file_size(cached, ec);
+            trimCache(ec ? 0 : size);
+        }
+    }
+    return true;
+}
+
+// 快取超過上限時，依最近使用時間淘汰最舊的執行檔，直到降到上限的 3/4。
+// 第一次呼叫時掃描資料夾取得目前大小，之後只累加新加入的檔案，平常不必重新掃描。
+void CompileService::trimCache(uintmax_t added) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    const uintmax_t limit = cacheLimitBytes();
+    std::error_code ec;
+
+    if (!cacheScanned) {
+        cacheBytes = 0;
+        for (const auto& entry : fs::directory_iterator(cacheRoot, ec)) {
+            if (entry.is_regular_file(ec)) cacheBytes += entry.file_size(ec);
+        }
+        cacheScanned = true;
+    } else {
+        cacheBytes += added;
+    }
+    if (cacheBytes <= limit) return;
+
+    struct CacheFile {
+        fs::path path;
+        fs::file_time_type used;
+        uintmax_t size;
+    };
+    std::vector<CacheFile> files;
+    cacheBytes = 0;
+    for (const auto& entry : fs::directory_iterator(cacheRoot, ec)) {
+        if (!entry.is_regular_file(ec)) continue;
+        CacheFile file{entry.path(), entry.last_write_time(ec), entry.file_size(ec)};
+        files.push_back(file);
+        cacheBytes += file.size;
+    }
+    std::sort(files.begin(), files.end(), [](const CacheFile& a, const CacheFile& b) { return a.used < b.used; });
+    for (const auto& file : files) {
+        if (cacheBytes <= limit / 4 * 3) break;
+        if (fs::remove(file.path, ec)) cacheBytes -= file.size;
+    }
+}
@@ -0,0 +1,343 @@
+// Contest.cpp
+
+#include "Contest.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <ctime>
+#include <filesystem>
+
+// --- Internal helpers ---
+namespace {
+    constexpr long long ICPC_PENALTY_MINUTES = 20; // 每次錯誤提交的罰時
+
+    std::string trimStr(const std::string& s) {
+        auto start = s.find_first_not_of(" \t\r\n");
+        auto end   = s.find_last_not_of(" \t\r\n");
+        return (start == std::string::npos) ? "" : s.substr(start, end - start + 1);
+    }
+
+    // 先寫到暫存檔再 rename，讀取的一方不會看到寫到一半的內容
+    bool writeFileAtomic(const std::string& path, const std::string& content) {
+        std::string tmpPath = path + ".tmp";
+        {
+            std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!(out << content)) return false;
+        }
+        std::error_code ec;
+        fs::rename(tmpPath, path, ec);
+        return !ec;
+    }
+}
+
+std::string contestModeName(ContestMode mode) {
+    return mode == ContestMode::IOI ? "IOI" : "ICPC";
+}
+
+bool parseContestMode(const std::string& s, ContestMode& mode) {
+    if (s == "ICPC" || s == "icpc") mode = ContestMode::ICPC;
+    else if (s == "IOI" || s == "ioi") mode = ContestMode::IOI;
+    else return false;
+    return true;
+}
+
+
+// --- Standings ---
+Standings::Standings(ContestMode mode, size_t problemCount) : mode(mode), problemCount(problemCount) {}
+
+Standings::Key Standings::keyOf(const Entry& entry) {
+    return Key(-entry.score, entry.penalty, entry.user);
+}
+
+// 第一次提交時加入排行榜
+Standings::Entry& Standings::entryOf(const std::string& user) {
+    auto it = entries.find(user);
+    if (it != entries.end()) return it->second;
+    Entry& entry = entries[user];
+    entry.user = user;
+    entry.cells.resize(problemCount);
+    tree.insert(keyOf(entry));
+    return entry;
+}
+
+// 只有這位參賽者的 key 會改變：移除舊的、插入新的，各 O(log n)
+void Standings::apply(const std::string& user, size_t problem, Verdict verdict, int score, long long minute) {
+    if (problem >= problemCount) return;
+    Entry& entry = entryOf(user);
+    Cell& cell = entry.cells[problem];
+    tree.erase(keyOf(entry));
+
+    if (mode == ContestMode::ICPC) {
+        // AC 之後的提交不影響成績；Compile Error 不計罰時
+        if (!cell.solved) {
+            if (verdict == Verdict::Accepted) {
+                cell.solved = true;
+                cell.solvedAt = minute;
+                entry.score++;
+                entry.penalty += minute + ICPC_PENALTY_MINUTES * cell.tries;
+            } else if (verdict != Verdict::CompileError) {
+                cell.tries++;
+            }
+        }
+    } else {
+        // IOI：每題取最高分
+        cell.tries++;
+        if (score > cell.score) {
+            entry.score += score - cell.score;
+            cell.score = score;
+            cell.solved = score == 100;
+        }
+    }
+
+    tree.insert(keyOf(entry));
+}
+
+// 公開排行榜上已解出的題目，之後的提交不會改變成績，不標示待定
+void Standings::markPending(const std::string& user, size_t problem) {
+    if (problem >= problemCount) return;
+    Cell& cell = entryOf(user).cells[problem];
+    if (!cell.solved) cell.pending++;
+}
+
+// 名次 = 成績嚴格比自己好的人數 + 1。以空字串作為 username 查詢，同分者都不會被算進去。
+int Standings::rankOfKey(const Key& key) const {
+    return (int)tree.order_of_key(Key(std::get<0>(key), std::get<1>(key), std::string())) + 1;
+}
+
+int Standings::rankOf(const std::string& user) const {
+    auto it = entries.find(user);
+    return it == entries.end() ? -1 : rankOfKey(keyOf(it->second));
+}
+
+ScoreRow Standings::rowOf(const Entry& entry) const {
+    ScoreRow row{rankOfKey(keyOf(entry)), entry.user, entry.score, entry.penalty, {}};
+    for (const Cell& cell : entry.cells) {
+        std::string text;
+        if (mode == ContestMode::ICPC) {
+            if (cell.solved) {
+                text = "+" + (cell.tries ? std::to_string(cell.tries) : "") + " (" + std::to_string(cell.solvedAt) + ")";
+            } else if (cell.tries) {
+                text = "-" + std::to_string(cell.tries);
+            }
+        } else if (cell.tries) {
+            text = std::to_string(cell.score);
+        }
+        if (cell.pending) text += (text.empty() ? "?" : " ?") + std::to_string(cell.pending);
+        row.cells.push_back(text);
+    }
+    return row;
+}
+
+std::vector<ScoreRow> Standings::top(size_t k) const {
+    std::vector<ScoreRow> rows;
+    for (auto it = tree.begin(); it != tree.end() && rows.size() < k; ++it) {
+        rows.push_back(rowOf(entries.at(std::get<2>(*it))));
+    }
+    return rows;
+}
+
+std::vector<ScoreRow> Standings::row(const std::string& user) const {
+    auto it = entries.find(user);
+    if (it == entries.end()) return {};
+    return {rowOf(it->second)};
+}
+
+
+// --- Contest ---
+Contest::Contest(std::string directory) : directory(std::move(directory)) {}
+
+// 讀取比賽設定，並依序重新套用所有已記錄的提交
+bool Contest::load() {
+    std::lock_guard<std::mutex> lock(mutex);
+    config = ContestConfig{};
+
+    std::ifstream file(directory + "/contest.csv");
+    if (!file) return false;
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t comma = line.find(',');
+        if (comma == std::string::npos) continue;
+        std::string key = trimStr(line.substr(0, comma));
+        std::string value = trimStr(line.substr(comma + 1));
+        try {
+            if (key == "name") config.name = value;
+            else if (key == "mode") parseContestMode(value, config.mode);
+            else if (key == "start") config.start = std::stoll(value);
+            else if (key == "end") config.end = std::stoll(value);
+            else if (key == "freeze") config.freezeMinutes = std::stoll(value);
+            else if (key == "problem" && !value.empty()) config.problems.push_back(value);
+            else if (key == "unfrozen") config.unfrozen = value == "1";
+        } catch (...) {
+            continue; // 格式錯誤的欄位略過
+        }
+    }
+    if (config.end <= config.start) {
+        config = ContestConfig{};
+        return false;
+    }
+
+    live = Standings(config.mode, config.problems.size());
+    board = Standings(config.mode, config.problems.size());
+
+    // submissions.csv: when,user,problem,verdict,passed,total
+    std::ifstream log(directory + "/submissions.csv");
+    while (std::getline(log, line)) {
+        std::stringstream ss(line);
+        std::string when, user, problem, verdictText, passed, total;
+        std::getline(ss, when, ',');
+        std::getline(ss, user, ',');
+        std::getline(ss, problem, ',');
+        std::getline(ss, verdictText, ',');
+        std::getline(ss, passed, ',');
+        std::getline(ss, total, ',');
+        Verdict verdict;
+        int index = problemIndex(problem);
+        if (index < 0 || !parseVerdict(verdictText, verdict)) continue;
+        try {
+            long long passedCount = std::stoll(passed), totalCount = std::stoll(total);
+            int score = totalCount > 0 ? (int)(passedCount * 100 / totalCount) : 0;
+            applyLocked(user, index, verdict, score, std::stoll(when));
+        } catch (...) {
+            continue;
+        }
+    }
+    if (config.unfrozen) board = live;
+    return true;
+}
+
+bool Contest::saveConfigLocked() const {
+    std::ostringstream out;
+    out << "name," << config.name << "\n"
+        << "mode," << contestModeName(config.mode) << "\n"
+        << "start," << config.start << "\n"
+        << "end," << config.end << "\n"
+        << "freeze," << config.freezeMinutes << "\n";
+    for (const auto& title : config.problems) out << "problem," << title << "\n";
+    if (config.unfrozen) out << "unfrozen,1\n";
+    return writeFileAtomic(directory + "/contest.csv", out.str());
+}
+
+bool Contest::create(const ContestConfig& newConfig) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+
+    // 上一場比賽的提交紀錄改名保存，不覆蓋先前保存的紀錄 (沒有載入比賽時以目前時間命名)
+    std::string logPath = directory + "/submissions.csv";
+    if (fs::exists(logPath, ec)) {
+        std::string stamp = std::to_string(config.start > 0 ? config.start : (long long)std::time(nullptr));
+        std::string archivePath = directory + "/submissions-" + stamp + ".csv";
+        for (int n = 1; fs::exists(archivePath, ec); ++n) {
+            archivePath = directory + "/submissions-" + stamp + "-" + std::to_string(n) + ".csv";
+        }
+        fs::rename(logPath, archivePath, ec);
+    }
+
+    config = newConfig;
+    config.unfrozen = false;
+    live = Standings(config.mode, config.problems.size());
+    board = Standings(config.mode, config.problems.size());
+    return saveConfigLocked();
+}
+
+int Contest::problemIndex(const std::string& title) const {
+    for (size_t i = 0; i < config.problems.size(); ++i) {
+        if (config.problems[i] == title) return (int)i;
+    }
+    return -1;
+}
+
+bool Contest::frozenLocked(long long now) const {
+    return config.freezeMinutes > 0 && now >= config.end - config.freezeMinutes * 60 && !config.unfrozen;
+}
+
+// 即時排行榜一律更新；封榜期間的提交在公開排行榜上只標示為待定
+void Contest::applyLocked(const std::string& user, int problem, Verdict verdict, int score, long long when) {
+    long long minute = (when - config.start) / 60;
+    live.apply(user, problem, verdict, score, minute);
+    if (frozenLocked(when)) board.markPending(user, problem);
+    else board.apply(user, problem, verdict, score, minute);
+}
+
+bool Contest::submit(const std::string& user, const std::string& problemTitle, Verdict verdict,
+                     size_t passed, size_t total, long long when) {
+    std::lock_guard<std::mutex> lock(mutex);
+    int index = problemIndex(problemTitle);
+    if (index < 0 || user.empty() || when < config.start || when >= config.end) return false;
+    // submissions.csv 以 ',' 分隔且重新載入時會重播，含 ',' 的名稱會讓整行錯位
+    if (user.find(',') != std::string::npos) return false;
+
+    // 先寫入紀錄再更新排行榜，寫入失敗時不計分，重新載入後的排行榜才會與目前一致
+    std::ofstream log(directory + "/submissions.csv", std::ios::app);
+    log << when << ',' << user << ',' << problemTitle << ',' << verdictName(verdict) << ','
+        << passed << ',' << total << '\n';
+    log.flush();
+    if (!log) return false;
+
+    int score = total > 0 ? (int)(passed * 100 / total) : 0;
+    applyLocked(user, index, verdict, score, when);
+    return true;
+}
+
+bool Contest::unfreeze() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (config.end == 0 || std::time(nullptr) < config.end) return false;
+    config.unfrozen = true;
+    board = live;
+    return saveConfigLocked();
+}
+
+std::vector<ScoreRow> Contest::scoreboard(size_t k, bool showLive) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return (showLive ? live : board).top(k);
+}
+
+std::vector<ScoreRow> Contest::userRow(const std::string& user, bool showLive) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return (showLive ? live : board).row(user);
+}
+
+size_t Contest::participants() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return live.size();
+}
+
+// 將整份排行榜輸出成 CSV：rank,user,score,penalty,<各題>
+std::string Contest::exportSnapshot(bool showLive) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Standings& standings = showLive ? live : board;
+
+    std::ostringstream out;
+    out << "rank,user," << (config.mode == ContestMode::ICPC ? "solved,penalty" : "score,penalty");
+    for (const auto& title : config.problems) out << ',' << title;
+    out << '\n';
+    for (const ScoreRow& row : standings.top(standings.size())) {
+        out << row.rank << ',' << row.username << ',' << row.score << ',' << row.penalty;
+        for (const auto& cell : row.cells) out << ',' << cell;
+        out << '\n';
+    }
+
+    std::string path = directory + "/scoreboard-" + std::to_string(std::time(nullptr))
+                     + (showLive ? "-live" : "") + ".csv";
+    return writeFileAtomic(path, out.str()) ? path : "";
+}
+
+ContestConfig Contest::getConfig() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return config;
+}
+
+bool Contest::isRunning(long long now) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return config.end > 0 && now >= config.start && now < config.end;
+}
+
+bool Contest::isFrozen(long long now) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return config.end > 0 && frozenLocked(now);
+}
+
+bool Contest::hasProblem(const std::string& title) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return problemIndex(title) >= 0;
+}
@@ -0,0 +1,305 @@
+// Cpu.cpp
+
+#include "Cpu.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <sstream>
+#include <thread>
+#include <filesystem>
+
+#ifdef __linux__
+#include <sched.h>
+#include <time.h>
+#include <sys/types.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// --- Internal helpers ---
+namespace {
+    constexpr int MAX_CPU = 4096; // 超出這個編號的範圍視為格式錯誤
+
+    bool contains(const std::vector<int>& cpus, int cpu) {
+        return std::find(cpus.begin(), cpus.end(), cpu) != cpus.end();
+    }
+
+    bool envFlag(const char* name) {
+        const char* value = std::getenv(name);
+        return value && std::string(value) == "1";
+    }
+
+    // 固定的 CPU 工作量：反覆走訪一塊 256 KB 的陣列
+    unsigned benchmarkWork() {
+        static std::vector<unsigned> data(64 * 1024, 1);
+        unsigned sum = 0;
+        for (int round = 0; round < 40; ++round) {
+            for (size_t i = 0; i < data.size(); ++i) {
+                sum += data[i] * (unsigned)(i ^ round);
+                data[i] = sum >> 3;
+            }
+        }
+        return sum;
+    }
+
+    // 模擬編譯的負載：在遠大於快取的陣列上持續讀寫，直到 stop 為止
+    void backgroundLoad(const std::atomic<bool>& stop) {
+        std::vector<unsigned> data(8 * 1024 * 1024, 1); // 32 MB
+        unsigned sum = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            for (size_t i = 0; i < data.size() && !stop.load(std::memory_order_relaxed); i += 16) {
+                sum += data[i];
+                data[i] = sum;
+            }
+        }
+    }
+
+    double nowCpuMs() {
+#ifdef __linux__
+        timespec ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+#else
+        using namespace std::chrono;
+        return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+#ifdef __linux__
+    std::vector<int> allowedCpus() {
+        std::vector<int> cpus;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) != 0) return cpus;
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+
+    std::vector<int> smtSiblings(int cpu) {
+        std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/thread_siblings_list");
+        std::string text;
+        std::getline(file, text);
+        return parseCpuList(text);
+    }
+
+    void pinCurrentThread(int cpu) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        sched_setaffinity(0, sizeof(set), &set);
+    }
+
+    // 把判題系統目前所有的執行緒限制在 cpus 上；之後建立的執行緒與子程序會繼承這個設定。
+    void restrictProcessTo(const std::vector<int>& cpus) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : cpus) CPU_SET(cpu, &set);
+        std::error_code ec;
+        for (auto& entry : fs::directory_iterator("/proc/self/task", ec)) {
+            try {
+                pid_t tid = (pid_t)std::stoi(entry.path().filename().string());
+                sched_setaffinity(tid, sizeof(set), &set);
+            } catch (...) {}
+        }
+    }
+#endif
+}
+
+std::vector<int> parseCpuList(const std::string& text) {
+    std::vector<int> cpus;
+    std::stringstream ss(text);
+    std::string part;
+    while (std::getline(ss, part, ',')) {
+        try {
+            size_t dash = part.find('-');
+            int first = std::stoi(part.substr(0, dash));
+            int last = (dash == std::string::npos) ? first : std::stoi(part.substr(dash + 1));
+            if (first < 0 || last >= MAX_CPU) continue;
+            for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+        } catch (...) {
+            continue; // 格式錯誤的片段略過
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+// 評測核心與 housekeeping 核心 (含兩者的 SMT sibling) 不重疊：編譯不會跑在評測核心的同一個實體核心上。
+CoreLayout planCores(const std::vector<int>& allowed, const std::string& requested, bool avoidSmt,
+                     const std::function<std::vector<int>(int)>& siblings) {
+    std::vector<int> candidates = allowed;
+    bool configured = false;
+    if (!requested.empty()) {
+        candidates.clear();
+        for (int cpu : parseCpuList(requested)) {
+            if (contains(allowed, cpu)) candidates.push_back(cpu);
+        }
+        configured = !candidates.empty();
+        if (!configured) candidates = allowed;
+    }
+
+    // 避開 SMT sibling：同一個實體核心只取一個邏輯核心
+    if (avoidSmt) {
+        std::vector<int> physical;
+        for (int cpu : candidates) {
+            bool siblingTaken = false;
+            for (int sibling : siblings(cpu)) {
+                if (sibling != cpu && contains(physical, sibling)) siblingTaken = true;
+            }
+            if (!siblingTaken) physical.push_back(cpu);
+        }
+        candidates = physical;
+    }
+
+    // 未指定時保留前面約四分之一的核心給判題系統與編譯；指定的核心涵蓋所有可用核心時保留第一個
+    auto busyWithJudge = [&](const std::vector<int>& judge, int cpu) {
+        if (contains(judge, cpu)) return true;
+        for (int core : judge) {
+            if (contains(siblings(core), cpu)) return true;
+        }
+        return false;
+    };
+    CoreLayout layout;
+    layout.judge = candidates;
+    if (!configured && candidates.size() >= 2) {
+        size_t reserved = std::max<size_t>(1, candidates.size() / 4);
+        layout.judge.erase(layout.judge.begin(), layout.judge.begin() + (long)reserved);
+    }
+    for (int cpu : allowed) {
+        if (!busyWithJudge(layout.judge, cpu)) layout.housekeeping.push_back(cpu);
+    }
+    if (layout.housekeeping.empty() && layout.judge.size() >= 2) {
+        layout.judge.erase(layout.judge.begin());
+        for (int cpu : allowed) {
+            if (!busyWithJudge(layout.judge, cpu)) layout.housekeeping.push_back(cpu);
+        }
+    }
+    return layout;
+}
+
+
+// --- CoreLease ---
+CoreLease::CoreLease(CorePool* pool, int cpu) : pool(pool), cpu(cpu) {}
+
+CoreLease::~CoreLease() {
+    if (pool) pool->release(cpu);
+}
+
+CoreLease::CoreLease(CoreLease&& other) noexcept : pool(other.pool), cpu(other.cpu) {
+    other.pool = nullptr;
+}
+
+CoreLease& CoreLease::operator=(CoreLease&& other) noexcept {
+    if (this != &other) {
+        if (pool) pool->release(cpu);
+        pool = other.pool;
+        cpu = other.cpu;
+        other.pool = nullptr;
+    }
+    return *this;
+}
+
+
+// --- CorePool ---
+CorePool::CorePool() {
+#ifdef __linux__
+    const char* requested = std::getenv("JUDGE_CPUS");
+    CoreLayout layout = planCores(allowedCpus(), requested ? requested : "", !envFlag("JUDGE_SMT"), smtSiblings);
+    cores = layout.judge;
+    housekeeping = layout.housekeeping;
+    // 判題系統的執行緒與 g++ 不會跑到評測核心上；之後建立的執行緒與子程序都繼承這個設定
+    if (!housekeeping.empty()) restrictProcessTo(housekeeping);
+#endif
+    if (cores.empty()) {
+        // 不支援綁核：只限制同時執行的數量
+        cores.assign(std::max(1u, std::thread::hardware_concurrency()), -1);
+    }
+    freeCores = cores;
+}
+
+CorePool& CorePool::instance() {
+    static CorePool pool;
+    return pool;
+}
+
+CoreLease CorePool::acquire() {
+    std::unique_lock<std::mutex> lock(mutex);
+    available.wait(lock, [this] { return !freeCores.empty(); });
+    int cpu = freeCores.back();
+    freeCores.pop_back();
+    return CoreLease(this, cpu);
+}
+
+void CorePool::release(int cpu) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        freeCores.push_back(cpu);
+    }
+    available.notify_one();
+}
+
+// 在評測核心上重複執行固定的工作量，以 p90 / 中位數估計計時誤差。量測期間每個 housekeeping 核心
+// 都跑著大量存取記憶體的負載 (相當於同時編譯)，因此包含共用快取與記憶體頻寬造成的干擾。
+// 時間限制乘上這個倍率 (介於 1 ~ 2 之間)，避免雜訊較大的機器把邊界上的程式誤判為 TLE。
+double CorePool::calibrate() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (calibrated) return scale;
+    }
+
+    CoreLease core = acquire();
+#ifdef __linux__
+    cpu_set_t original;
+    sched_getaffinity(0, sizeof(original), &original);
+    if (core.get() >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core.get(), &set);
+        sched_setaffinity(0, sizeof(set), &set);
+    }
+#endif
+
+    std::atomic<bool> stopLoad{false};
+    std::vector<std::thread> load;
+#ifdef __linux__
+    for (int cpu : housekeeping) {
+        load.emplace_back([&stopLoad, cpu] {
+            pinCurrentThread(cpu);
+            backgroundLoad(stopLoad);
+        });
+    }
+#endif
+
+    const int warmups = 2, runs = 15;
+    std::vector<double> samples;
+    volatile unsigned sink = 0;
+    for (int i = 0; i < warmups + runs; ++i) {
+        double start = nowCpuMs();
+        sink = sink + benchmarkWork();
+        double elapsed = nowCpuMs() - start;
+        if (i >= warmups) samples.push_back(elapsed);
+    }
+    stopLoad = true;
+    for (auto& thread : load) thread.join();
+
+#ifdef __linux__
+    sched_setaffinity(0, sizeof(original), &original);
+#endif
+
+    std::sort(samples.begin(), samples.end());
+    double median = samples[samples.size() / 2];
+    double p90 = samples[samples.size() * 9 / 10];
+    double measured = (median > 0) ? p90 / median : 1.0;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    scale = std::clamp(measured, 1.0, 2.0);
+    calibrated = true;
+    return scale;
+}
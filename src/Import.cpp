@@ -0,0 +1,448 @@
+// Import.cpp
+
+#include "Import.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <deque>
+#include <set>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <fstream>
+#include <cerrno>
+#include <climits>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+#ifndef RENAME_EXCHANGE
+#define RENAME_EXCHANGE (1 << 1)
+#endif
+
+// --- Internal helpers ---
+namespace {
+    constexpr size_t TAR_BLOCK = 512;
+    constexpr size_t CHUNK_BYTES = 4 * 1024 * 1024;           // 每次交給寫入執行緒的區塊大小
+    constexpr size_t QUEUE_BYTES = 64 * 1024 * 1024;          // 尚未寫入的資料上限，避免整個封存檔進到記憶體
+    constexpr size_t META_BYTES = 64 * 1024;                  // 長檔名與 pax header 的大小上限 (整筆讀進記憶體)
+
+    bool endsWith(const std::string& s, const std::string& suffix) {
+        return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    // 依副檔名開啟封存檔：.tar 直接讀取，.tar.gz / .tgz 透過 gzip 解壓後以 pipe 讀取。
+    class ArchiveStream {
+    private:
+        FILE* fp = nullptr;
+        bool piped = false;
+
+    public:
+        ~ArchiveStream() { close(); }
+
+        bool open(const std::string& path, std::string& error) {
+            if (endsWith(path, ".zip")) {
+                error = "zip archives are not supported, please repack as .tar or .tar.gz";
+                return false;
+            }
+            if (endsWith(path, ".tar.gz") || endsWith(path, ".tgz")) {
+#ifdef _WIN32
+                error = "compressed archives are not supported on Windows, please use .tar";
+                return false;
+#else
+                if (!fs::exists(path)) {
+                    error = "archive not found: " + path;
+                    return false;
+                }
+                std::string quoted = "'";
+                for (char c : path) quoted += (c == '\'') ? std::string("'\\''") : std::string(1, c);
+                quoted += "'";
+                fp = popen(("gzip -dc -- " + quoted).c_str(), "r");
+                piped = true;
+#endif
+            } else {
+                fp = std::fopen(path.c_str(), "rb");
+            }
+            if (!fp) error = "cannot open archive: " + path;
+            return fp != nullptr;
+        }
+
+        // 讀滿 n 個位元組，除非遇到結尾；回傳實際讀到的數量
+        size_t read(char* buffer, size_t n) {
+            size_t total = 0;
+            while (total < n) {
+                size_t got = std::fread(buffer + total, 1, n - total, fp);
+                if (got == 0) break;
+                total += got;
+            }
+            return total;
+        }
+
+        bool skip(unsigned long long n) {
+            char scratch[64 * 1024];
+            while (n > 0) {
+                size_t want = (size_t)std::min<unsigned long long>(n, sizeof(scratch));
+                if (read(scratch, want) != want) return false;
+                n -= want;
+            }
+            return true;
+        }
+
+        // 讀到資料結尾。tar 的結尾區塊之後仍可能有填充 (例如 tar -b 256)，
+        // 不讀完就關閉 pipe 時 gzip 會因 SIGPIPE 結束，被誤判為解壓失敗。
+        void drain() {
+            if (!fp) return;
+            char scratch[64 * 1024];
+            while (read(scratch, sizeof(scratch)) == sizeof(scratch)) {}
+        }
+
+        // 關閉；解壓程式回報錯誤時回傳 false
+        bool close() {
+            if (!fp) return true;
+            bool ok = true;
+#ifndef _WIN32
+            if (piped) ok = pclose(fp) == 0;
+            else
+#endif
+            std::fclose(fp);
+            fp = nullptr;
+            return ok;
+        }
+    };
+
+    // 暫存資料夾中的一個輸出檔，允許多個執行緒依 offset 同時寫入不同區塊。
+    class StagedFile {
+    private:
+#ifdef _WIN32
+        std::mutex mutex;
+        std::fstream file;
+#else
+        int fd = -1;
+#endif
+
+    public:
+        explicit StagedFile(const fs::path& path) {
+#ifdef _WIN32
+            file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+#else
+            fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+#endif
+        }
+
+        ~StagedFile() {
+#ifndef _WIN32
+            if (fd >= 0) ::close(fd);
+#endif
+        }
+
+        bool ok() const {
+#ifdef _WIN32
+            return file.is_open();
+#else
+            return fd >= 0;
+#endif
+        }
+
+        bool writeAt(unsigned long long offset, const char* data, size_t size) {
+#ifdef _WIN32
+            std::lock_guard<std::mutex> lock(mutex);
+            file.seekp((std::streamoff)offset);
+            file.write(data, (std::streamsize)size);
+            return (bool)file;
+#else
+            while (size > 0) {
+                ssize_t n = pwrite(fd, data, size, (off_t)offset);
+                if (n <= 0) return false;
+                data += n;
+                size -= (size_t)n;
+                offset += (unsigned long long)n;
+            }
+            return true;
+#endif
+        }
+    };
+
+    struct Chunk {
+        std::shared_ptr<StagedFile> file;   // 最後一個區塊寫完時自動關閉檔案
+        unsigned long long offset;
+        std::vector<char> data;
+    };
+
+    // 寫入執行緒池：讀取端 push 區塊，佇列中的資料超過 QUEUE_BYTES 時 push 會阻塞。
+    class ChunkWriter {
+    private:
+        std::deque<Chunk> queue;
+        size_t queuedBytes = 0;
+        bool closed = false;
+        bool failed = false;
+        std::mutex mutex;
+        std::condition_variable workAvailable;
+        std::condition_variable spaceAvailable;
+        std::vector<std::thread> workers;
+
+        void workerLoop() {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (true) {
+                workAvailable.wait(lock, [this] { return !queue.empty() || closed; });
+                if (queue.empty()) return;
+                Chunk chunk = std::move(queue.front());
+                queue.pop_front();
+                lock.unlock();
+
+                bool ok = chunk.file->writeAt(chunk.offset, chunk.data.data(), chunk.data.size());
+                size_t size = chunk.data.size();
+                chunk = Chunk{}; // 在鎖外釋放緩衝區與檔案
+
+                lock.lock();
+                if (!ok) failed = true;
+                queuedBytes -= size;
+                spaceAvailable.notify_one();
+            }
+        }
+
+    public:
+        explicit ChunkWriter(size_t workerCount) {
+            for (size_t i = 0; i < workerCount; ++i) workers.emplace_back(&ChunkWriter::workerLoop, this);
+        }
+
+        ~ChunkWriter() { finish(); }
+
+        // 回傳 false 代表已有寫入失敗，讀取端應停止
+        bool push(Chunk chunk) {
+            std::unique_lock<std::mutex> lock(mutex);
+            spaceAvailable.wait(lock, [this] { return queuedBytes < QUEUE_BYTES || failed; });
+            if (failed) return false;
+            queuedBytes += chunk.data.size();
+            queue.push_back(std::move(chunk));
+            workAvailable.notify_one();
+            return true;
+        }
+
+        // 等待所有區塊寫完；回傳是否全部成功
+        bool finish() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                closed = true;
+            }
+            workAvailable.notify_all();
+            for (auto& worker : workers) worker.join();
+            workers.clear();
+            return !failed;
+        }
+    };
+
+    // tar 的數字欄位：一般為 8 進位 ASCII，超過 8 GB 的檔案以 base-256 (最高位元為 1) 表示
+    unsigned long long parseTarNumber(const char* field, size_t length) {
+        unsigned long long value = 0;
+        if ((unsigned char)field[0] & 0x80) {
+            value = (unsigned char)field[0] & 0x7f;
+            for (size_t i = 1; i < length; ++i) value = (value << 8) | (unsigned char)field[i];
+            return value;
+        }
+        for (size_t i = 0; i < length && field[i]; ++i) {
+            if (field[i] >= '0' && field[i] <= '7') value = value * 8 + (field[i] - '0');
+        }
+        return value;
+    }
+
+    std::string fieldString(const char* field, size_t length) {
+        return std::string(field, strnlen(field, length));
+    }
+
+    bool checksumValid(const char* header) {
+        unsigned long long expected = parseTarNumber(header + 148, 8);
+        unsigned long long sum = 0;
+        for (size_t i = 0; i < TAR_BLOCK; ++i) {
+            sum += (i >= 148 && i < 156) ? ' ' : (unsigned char)header[i];
+        }
+        return sum == expected;
+    }
+
+    // 十進位非負整數，整個字串都必須是數字；格式錯誤或超出範圍時回傳 false
+    bool parseDecimal(const std::string& text, unsigned long long& value) {
+        if (text.empty() || text[0] < '0' || text[0] > '9') return false;
+        errno = 0;
+        char* end = nullptr;
+        value = std::strtoull(text.c_str(), &end, 10);
+        return errno == 0 && *end == '\0';
+    }
+
+    // pax extended header：每筆紀錄為 "<長度> <key>=<value>\n"，只取 path 與 size。
+    // 格式錯誤時回傳 false
+    bool parsePaxHeader(const std::string& data, std::string& path, long long& size) {
+        size_t pos = 0;
+        while (pos < data.size()) {
+            size_t space = data.find(' ', pos);
+            unsigned long long length = 0;
+            if (space == std::string::npos || !parseDecimal(data.substr(pos, space - pos), length)) return false;
+            if (length < space - pos + 2 || length > data.size() - pos || data[pos + length - 1] != '\n') return false;
+            std::string record = data.substr(space + 1, pos + length - space - 2); // 去掉結尾的 '\n'
+            size_t eq = record.find('=');
+            if (eq != std::string::npos) {
+                std::string key = record.substr(0, eq);
+                if (key == "path") {
+                    path = record.substr(eq + 1);
+                } else if (key == "size") {
+                    unsigned long long value = 0;
+                    if (!parseDecimal(record.substr(eq + 1), value) || value > (unsigned long long)LLONG_MAX) return false;
+                    size = (long long)value;
+                }
+            }
+            pos += length;
+        }
+        return true;
+    }
+}
+
+bool extractTestArchive(const std::string& archivePath, const fs::path& stagingDir, ImportReport& report) {
+    std::error_code ec;
+    if (!fs::create_directory(stagingDir, ec)) {
+        report.error = "cannot create staging directory: " + stagingDir.string();
+        return false;
+    }
+
+    ArchiveStream stream;
+    if (!stream.open(archivePath, report.error)) return false;
+
+    unsigned hw = std::thread::hardware_concurrency();
+    ChunkWriter writer(std::min(4u, std::max(2u, hw)));
+
+    std::set<std::string> inputs, outputs, written;
+    std::string longName, paxPath;
+    long long paxSize = -1;
+    char header[TAR_BLOCK];
+
+    auto fail = [&](const std::string& message) {
+        report.error = message;
+        writer.finish();
+        return false;
+    };
+
+    while (true) {
+        size_t got = stream.read(header, TAR_BLOCK);
+        if (got == 0) break; // 沒有結尾區塊也視為正常結束
+        if (got < TAR_BLOCK) return fail("truncated archive");
+        if (std::all_of(header, header + TAR_BLOCK, [](char c) { return c == 0; })) break;
+        if (!checksumValid(header)) return fail("corrupted tar header (bad checksum)");
+
+        char type = header[156];
+        unsigned long long size = paxSize >= 0 ? (unsigned long long)paxSize : parseTarNumber(header + 124, 12);
+        unsigned long long padding = (TAR_BLOCK - size % TAR_BLOCK) % TAR_BLOCK;
+
+        // 長檔名與 pax header 的內容套用到下一個項目
+        if (type == 'L' || type == 'x') {
+            if (size > META_BYTES) return fail("tar metadata record too large");
+            std::string data(size, '\0');
+            if (stream.read(&data[0], size) != size || !stream.skip(padding)) return fail("truncated archive");
+            if (type == 'L') longName = data.c_str();
+            else if (!parsePaxHeader(data, paxPath, paxSize)) return fail("corrupted pax header");
+            continue;
+        }
+
+        std::string name;
+        if (!paxPath.empty()) name = paxPath;
+        else if (!longName.empty()) name = longName;
+        else {
+            name = fieldString(header, 100);
+            std::string prefix = fieldString(header + 345, 155);
+            if (std::memcmp(header + 257, "ustar", 5) == 0 && !prefix.empty()) name = prefix + "/" + name;
+        }
+        longName.clear();
+        paxPath.clear();
+        paxSize = -1;
+
+        std::string base = fs::path(name).filename().string();
+        std::string ext = fs::path(base).extension().string();
+        bool regular = type == '0' || type == '\0' || type == '7';
+        bool wanted = regular && !base.empty() && base[0] != '.'
+                   && (ext == ".in" || ext == ".out" || base == "description.txt");
+        if (!wanted) {
+            if (regular) report.skipped++;
+            if (!stream.skip(size + padding)) return fail("truncated archive");
+            continue;
+        }
+        if (!written.insert(base).second) return fail("duplicate file name in archive: " + base);
+
+        std::string stem = fs::path(base).stem().string();
+        if (ext == ".in") inputs.insert(stem);
+        else if (ext == ".out") outputs.insert(stem);
+        else report.hasDescription = true;
+
+        auto file = std::make_shared<StagedFile>(stagingDir / base);
+        if (!file->ok()) return fail("cannot create " + (stagingDir / base).string());
+
+        // 內容切成區塊交給寫入執行緒；讀取端只負責依序讀封存檔
+        for (unsigned long long offset = 0; offset < size; ) {
+            size_t length = (size_t)std::min<unsigned long long>(CHUNK_BYTES, size - offset);
+            Chunk chunk{file, offset, std::vector<char>(length)};
+            if (stream.read(chunk.data.data(), length) != length) return fail("truncated archive");
+            if (!writer.push(std::move(chunk))) return fail("write error in staging directory");
+            offset += length;
+        }
+        report.bytes += size;
+        if (!stream.skip(padding)) return fail("truncated archive");
+    }
+
+    if (!writer.finish()) {
+        report.error = "write error in staging directory";
+        return false;
+    }
+    stream.drain();
+    if (!stream.close()) {
+        report.error = "failed to decompress archive";
+        return false;
+    }
+
+    // 驗證配對：每個 .in 都要有 .out，反之亦然
+    for (const auto& stem : inputs) {
+        if (!outputs.count(stem)) {
+            report.error = "missing " + stem + ".out";
+            return false;
+        }
+    }
+    for (const auto& stem : outputs) {
+        if (!inputs.count(stem)) {
+            report.error = "missing " + stem + ".in";
+            return false;
+        }
+    }
+    if (inputs.empty()) {
+        report.error = "no .in/.out test cases found in archive";
+        return false;
+    }
+    report.cases = inputs.size();
+
+    // description.txt 不屬於測資，之後由呼叫端搬到題目資料夾
+    return true;
+}
+
+bool replaceDirectory(const fs::path& staging, const fs::path& target) {
+    std::error_code ec;
+    if (!fs::exists(target, ec)) {
+        fs::rename(staging, target, ec);
+        return !ec;
+    }
+#if defined(__linux__) && defined(SYS_renameat2)
+    if (syscall(SYS_renameat2, AT_FDCWD, staging.c_str(), AT_FDCWD, target.c_str(), RENAME_EXCHANGE) == 0) {
+        fs::remove_all(staging, ec); // 交換後 staging 內是舊的測資
+        return true;
+    }
+#endif
+    fs::path old = staging;
+    old += ".old";
+    fs::rename(target, old, ec);
+    if (ec) return false;
+    fs::rename(staging, target, ec);
+    if (ec) {
+        fs::rename(old, target, ec);
+        return false;
+    }
+    fs::remove_all(old, ec);
+    return true;
+}
@@ -3,6 +3,11 @@
 #include "Judge.hpp"
 #include "ColorPrint.hpp"
 #include "Utils.hpp"
+#include "Trace.hpp"
+#include "Similarity.hpp"
+#include "Cpu.hpp"
+#include "Sandbox.hpp"
+#include "Contest.hpp"
 
 #include <iostream>
 #include <thread>
@@ -10,6 +15,12 @@
 #include <fstream>
 #include <vector>
 #include <stdexcept>
+#include <iomanip>
+#include <algorithm>
+#include <limits>
+#include <cstdio>
+#include <sstream>
+#include <ctime>
 
 // Constructor
 JudgeSystem::JudgeSystem(const std::string& userPath,
@@ -62,7 +73,9 @@ namespace {
                            "(5) Submit code\n")
                     << red("(6) Add new problem (admin only)\n")
                  << yellow("(7) Sign out\n"
-                           "(8) Exit program\n");
+                           "(8) Exit program\n")
+                << magenta("(9) Contest scoreboard\n"
+                           "(10) New contest (admin only)\n");
 
         // Bottom border
         std::cout << "+" << std::string(35, '-') << "+\n";
@@ -70,6 +83,53 @@ namespace {
 
         return;
     }
+
+    // epoch 秒 -> "2025-01-01 13:00"
+    std::string formatTime(long long epoch) {
+        std::time_t t = (std::time_t)epoch;
+        std::ostringstream out;
+        out << std::put_time(std::localtime(&t), "%Y-%m-%d %H:%M");
+        return out.str();
+    }
+
+    // 秒數 -> "01:23:45"
+    std::string formatDuration(long long seconds) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%02lld:%02lld:%02lld", seconds / 3600, seconds / 60 % 60, seconds % 60);
+        return buf;
+    }
+
+    // 讀取 [low, high] 範圍內的分鐘數；輸入結束時回傳 -1
+    long long readMinutes(const char* prompt, long long low, long long high) {
+        while (true) {
+            std::cout << "\033[33m" << prompt << "\033[0m";
+            long long value;
+            if (std::cin >> value && value >= low && value <= high) return value;
+            if (std::cin.eof()) return -1;
+            std::cin.clear();
+            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            std::cout << red("Please enter a number between ") << low << " and " << high << ".\n";
+        }
+    }
+
+    // 輸出排行榜；題目以 A, B, C... 表示
+    void printScoreRows(const ContestConfig& config, const std::vector<ScoreRow>& rows) {
+        bool icpc = config.mode == ContestMode::ICPC;
+        std::cout << std::left << std::setw(6) << "Rank" << std::setw(16) << "User"
+                  << std::setw(8) << (icpc ? "Solved" : "Score");
+        if (icpc) std::cout << std::setw(9) << "Penalty";
+        for (size_t i = 0; i < config.problems.size(); ++i) {
+            std::cout << std::setw(10) << std::string(1, (char)('A' + i % 26));
+        }
+        std::cout << "\n";
+        for (const auto& row : rows) {
+            std::cout << std::setw(6) << row.rank << std::setw(16) << row.username << std::setw(8) << row.score;
+            if (icpc) std::cout << std::setw(9) << row.penalty;
+            for (const auto& cell : row.cells) std::cout << std::setw(10) << cell;
+            std::cout << "\n";
+        }
+        std::cout << std::right;
+    }
 }
 
 
@@ -87,11 +147,39 @@ void JudgeSystem::loadData() {
     problemSystem.init(problemDataPath);
     effectLoading("Status - Loading problem data...");
     std::cout << green("Status - Loading problem data...OK!\n");
+    std::cout << green("Status - Judge cores: ") << CorePool::instance().getCores().size()
+              << green(", time limit scale x") << CorePool::instance().timeScale() << "\n";
+    std::cout << green("Status - Sandbox: ") << SandboxPool::instance().getStatus() << "\n";
 
     // Step3: 歡迎使用者
     printLoginMsg();
 }
 
+// 重播模式：不需登入，只載入題目後依 trace 重新評測所有提交並輸出報告。
+void JudgeSystem::replayProcess(const std::string& tracePath, double speed) {
+    problemSystem.init(problemDataPath);
+    auto trace = loadTrace(tracePath);
+    std::cout << yellow("Replaying ") << trace.size() << " submissions from " << tracePath << " at ";
+    if (speed > 0) std::cout << speed << "x speed...\n";
+    else std::cout << "max speed...\n";
+    printReplayReport(replayTrace(problemSystem, trace, speed));
+}
+
+// 相似度檢查模式：對資料夾內所有程式碼建立索引，列出相似度超過 threshold 的配對。
+void JudgeSystem::similarityProcess(const std::string& directory, double threshold) {
+    SimilarityIndex index(12, 8, threshold);
+    std::vector<SimilarityMatch> matches;
+    index.build(directory, &matches);
+    std::cout << yellow("Indexed ") << index.size() << " source files in " << directory << "\n";
+    printSimilarityReport(matches, index.commonCount());
+}
+
+// 匯入模式：不需登入，將封存檔中的測資匯入指定題目 (不存在則建立)。
+bool JudgeSystem::importProcess(const std::string& archivePath, const std::string& title, int timeLimitMs) {
+    problemSystem.init(problemDataPath);
+    return problemSystem.importTestcases(title, archivePath, timeLimitMs);
+}
+
 // 系統狀態分成以下三種：未初始化 (NOT READY)、使用者未登入 (USER LOGIN)、使用者已登入 (READY)。
 // 不同狀態下將程式導向對應的 Function。
 void JudgeSystem::loginProcess() {
@@ -122,10 +210,11 @@ bool JudgeSystem::mainPageProcess() {
     std::cout << blue("User input: ") << input << '\n';
 
     int opt;
-    if (input.length() == 1 && input[0] >= '1' && input[0] <= '8') {
-        opt = input[0] - '0'; // 轉為 int
+    if (!input.empty() && input.length() <= 2 && std::all_of(input.begin(), input.end(), ::isdigit)
+        && std::stoi(input) >= 1 && std::stoi(input) <= 10) {
+        opt = std::stoi(input); // 轉為 int
     } else {
-        std::cout << red("Invalid input. Please enter a number between 1 and 8.\n");
+        std::cout << red("Invalid input. Please enter a number between 1 and 10.\n");
         return true; // 回到主選單
     }
 
@@ -141,7 +230,9 @@ bool JudgeSystem::mainPageProcess() {
         case 3: {
             // 列出並讓使用者選題目
             // 如果沒有題目，則結束流程。
-            if (!problemSystem.listAllProblems()) break;
+            // 題號對照畫面上列出的那份快照，期間題目清單重新載入也不會選到別的題目
+            auto problems = problemSystem.listAllProblems();
+            if (!problems) break;
 
             std::cout << cyan("Do you want to select a problem to solve? (y/n): ");
             if (!promptYesNo()) {
@@ -154,7 +245,7 @@ bool JudgeSystem::mainPageProcess() {
                 std::cout << yellow("Please input the problem ID: ");
                 std::cin >> problemId;
 
-                if (problemId < 1 || problemId > (int)problemSystem.getProblemList().size()) {
+                if (problemId < 1 || problemId > (int)problems->size()) {
                     std::cout << red("Invalid problem ID.\n");
                     continue;
                 }
@@ -162,14 +253,15 @@ bool JudgeSystem::mainPageProcess() {
             }
 
             // 顯示題目說明並提交判題
-            problemSystem.printProblemDescription(problemId);
-            problemSystem.submitCode(problemId);            
+            const Problem problem = (*problems)[problemId - 1];
+            problemSystem.printProblemDescription(problem);
+            problemSystem.submitCode(problem, accountSystem.getuserLogin());
             break;
         }
         case 4: {
             // 隨機題目
-            int idx = problemSystem.randomProblem(); // returns -1 if no problem
-            if (idx == -1) break;
+            auto problem = problemSystem.randomProblem(); // 沒有題目時為空
+            if (!problem) break;
 
             std::cout << yellow("Do you want to solve this problem? (y/n): ");
             if (!promptYesNo()) {
@@ -177,24 +269,25 @@ bool JudgeSystem::mainPageProcess() {
                 break;
             }
             
-            problemSystem.submitCode(idx + 1); // submitCode uses 1-based id
+            problemSystem.submitCode(*problem, accountSystem.getuserLogin());
             break;
         }
         case 5: {
             // 單獨提交程式碼（無題目說明）
-            if (!problemSystem.listAllProblems()) break;
+            auto problems = problemSystem.listAllProblems();
+            if (!problems) break;
 
             while (true) {
                 int problemId;
                 std::cout << yellow("Please input the problem ID to submit: ");
                 std::cin >> problemId;
 
-                if (problemId < 1 || problemId > (int)problemSystem.getProblemList().size()) {
+                if (problemId < 1 || problemId > (int)problems->size()) {
                     std::cout << red("Invalid problem ID.\n");
                     continue;
                 }
 
-                problemSystem.submitCode(problemId);
+                problemSystem.submitCode((*problems)[problemId - 1], accountSystem.getuserLogin());
                 break;
             }
             break;
@@ -209,6 +302,7 @@ bool JudgeSystem::mainPageProcess() {
         }
         case 7: {
             std::cout << yellow("User logged out!!\n\n");
+            accountSystem.logout(accountSystem.loginToken);
             status = "USER LOGIN";
             loginProcess(); // 回到登入流程
             return false; // exit
@@ -223,6 +317,18 @@ bool JudgeSystem::mainPageProcess() {
             );
             return false; // exit
         }
+        case 9: {
+            scoreboardProcess();
+            break;
+        }
+        case 10: {
+            if (accountSystem.getuserLogin() == "admin") {
+                newContestProcess();
+            } else {
+                std::cout << red("Only admin can create a contest!\n");
+            }
+            break;
+        }
         default: {
             std::cout << red("Invalid option. Please try again.\n");
             break;
@@ -230,4 +336,124 @@ bool JudgeSystem::mainPageProcess() {
     }
 
     return true;
-}
\ No newline at end of file
+}
+
+// 比賽排行榜：一般使用者看到公開排行榜 (封榜期間名次不再更新)，管理員看到即時排行榜。
+void JudgeSystem::scoreboardProcess() {
+    auto& contest = problemSystem.contest;
+    ContestConfig config = contest ? contest->getConfig() : ContestConfig{};
+    if (config.end == 0) {
+        std::cout << yellow("No contest has been set up.\n");
+        return;
+    }
+
+    std::string username = accountSystem.getuserLogin();
+    bool isAdmin = username == "admin";
+    long long now = std::time(nullptr);
+    bool frozen = contest->isFrozen(now);
+
+    std::cout << cyan("=== Contest: ") << config.name << " (" << contestModeName(config.mode) << ")" << cyan(" ===\n");
+    std::cout << "Time: " << formatTime(config.start) << " ~ " << formatTime(config.end) << "\n";
+    if (now < config.start) std::cout << yellow("Status: Starts in ") << formatDuration(config.start - now) << "\n";
+    else if (now < config.end) std::cout << green("Status: Running, ") << formatDuration(config.end - now) << " left\n";
+    else std::cout << yellow("Status: Ended\n");
+    if (frozen) {
+        std::cout << blue("The scoreboard is frozen") << (isAdmin ? " (showing live results)\n" : ", pending results are marked with ?\n");
+    }
+    for (size_t i = 0; i < config.problems.size(); ++i) {
+        std::cout << (char)('A' + i % 26) << " = " << config.problems[i] << "\n";
+    }
+    std::cout << "\n";
+
+    const size_t TOP_K = 10;
+    printScoreRows(config, contest->scoreboard(TOP_K, isAdmin));
+    auto mine = contest->userRow(username, isAdmin);
+    if (!mine.empty()) {
+        std::cout << green("\nYour rank: ") << mine[0].rank << " / " << contest->participants() << "\n";
+        if (mine[0].rank > (int)TOP_K) printScoreRows(config, mine);
+    }
+
+    if (!isAdmin) return;
+    std::cout << yellow("\nExport a snapshot of the public scoreboard? (y/n): ");
+    if (promptYesNo()) {
+        std::string path = contest->exportSnapshot(false);
+        if (path.empty()) std::cout << red("Failed to export the scoreboard.\n");
+        else std::cout << green("Scoreboard exported to ") << path << "\n";
+    }
+    if (frozen && now >= config.end) {
+        std::cout << yellow("Unfreeze the scoreboard and publish the final results? (y/n): ");
+        if (promptYesNo()) {
+            if (contest->unfreeze()) std::cout << green("Final results published.\n");
+            else std::cout << red("Failed to unfreeze the scoreboard.\n");
+        }
+    }
+}
+
+// 建立新比賽：取代目前的比賽設定，舊的提交紀錄會改名保存。
+void JudgeSystem::newContestProcess() {
+    auto problems = problemSystem.getProblemList();
+    if (problems->empty()) {
+        std::cout << red("There are no problems to build a contest from.\n");
+        return;
+    }
+
+    // 進行中的比賽會被取代 (提交紀錄另存)，必須先確認
+    if (problemSystem.contest->isRunning((long long)std::time(nullptr))) {
+        ContestConfig current = problemSystem.contest->getConfig();
+        std::cout << red("A contest is running: ") << current.name << " (ends " << formatTime(current.end) << ")\n";
+        std::cout << yellow("Replace it with a new contest? (y/n): ");
+        if (!promptYesNo()) return;
+    }
+
+    ContestConfig config;
+    std::cout << yellow("Contest name: ");
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    std::getline(std::cin, config.name);
+    if (config.name.empty()) config.name = "Contest";
+
+    std::string mode;
+    while (true) {
+        std::cout << yellow("Scoring mode (ICPC/IOI): ");
+        std::cin >> mode;
+        if (parseContestMode(mode, config.mode)) break;
+        std::cout << red("Please enter ICPC or IOI.\n");
+    }
+
+    long long startIn = readMinutes("Start in how many minutes (0 = now): ", 0, 365LL * 24 * 60);
+    long long duration = readMinutes("Duration in minutes: ", 1, 365LL * 24 * 60);
+    long long freeze = readMinutes("Freeze the scoreboard how many minutes before the end (0 = never): ", 0, duration);
+    if (startIn < 0 || duration < 0 || freeze < 0) return;
+
+    problems = problemSystem.listAllProblems(); // 題號對照畫面上列出的快照
+    if (!problems) return;
+    std::cout << yellow("Problem IDs separated by spaces (empty = all): ");
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    std::string line;
+    std::getline(std::cin, line);
+    std::stringstream ss(line);
+    int id;
+    while (ss >> id) {
+        if (id < 1 || id > (int)problems->size()) {
+            std::cout << red("Skipping invalid problem ID ") << id << "\n";
+            continue;
+        }
+        const std::string& title = (*problems)[id - 1].getTitle();
+        if (std::find(config.problems.begin(), config.problems.end(), title) == config.problems.end()) {
+            config.problems.push_back(title);
+        }
+    }
+    if (config.problems.empty()) {
+        for (const auto& p : *problems) config.problems.push_back(p.getTitle());
+    }
+
+    config.start = (long long)std::time(nullptr) + startIn * 60;
+    config.end = config.start + duration * 60;
+    config.freezeMinutes = freeze;
+    if (!problemSystem.contest->create(config)) {
+        std::cout << red("Failed to save the contest settings.\n");
+        return;
+    }
+    std::cout << green("Contest created: ") << config.name << " (" << contestModeName(config.mode) << ", "
+              << config.problems.size() << " problems, " << formatTime(config.start) << " ~ "
+              << formatTime(config.end) << ")\n";
+}
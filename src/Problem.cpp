@@ -1,6 +1,16 @@
 // Problem.cpp
 
 #include "Problem.hpp"
+#include "Trace.hpp"
+#include "Runner.hpp"
+#include "Compiler.hpp"
+#include "Similarity.hpp"
+#include "Watcher.hpp"
+#include "Cpu.hpp"
+#include "AsyncIo.hpp"
+#include "Import.hpp"
+#include "Sandbox.hpp"
+#include "Contest.hpp"
 #include "ColorPrint.hpp"
 #include "Utils.hpp"
 
@@ -8,23 +18,38 @@
 #include <fstream>
 #include <sstream>
 #include <filesystem>
-#include <cstdlib>
 #include <algorithm>
 #include <random>
 #include <limits>
-
-#ifdef _WIN32
-#define COMPILE_CMD "g++ %s -o build/user_program.exe"
-#define RUN_CMD ".\\build\\user_program.exe < %s > data/user/user_output.txt"
-#else
-#define COMPILE_CMD "g++ %s -o build/user_program"
-#define RUN_CMD "./build/user_program < %s > data/user/user_output.txt"
-#endif
+#include <chrono>
+#include <cstdio>
 
 namespace fs = std::filesystem;
 
-Problem::Problem(std::string t, std::string b)
-    : title(std::move(t)), basePath(std::move(b)) {}
+Problem::Problem(std::string t, std::string b, int limitMs)
+    : title(std::move(t)), basePath(std::move(b)), timeLimitMs(limitMs) {}
+
+std::string verdictName(Verdict v) {
+    switch (v) {
+        case Verdict::Accepted:     return "AC";
+        case Verdict::WrongAnswer:  return "WA";
+        case Verdict::RuntimeError: return "RE";
+        case Verdict::TimeLimitExceeded: return "TLE";
+        case Verdict::CompileError: return "CE";
+    }
+    return "??";
+}
+
+bool parseVerdict(const std::string& s, Verdict& v) {
+    for (Verdict c : {Verdict::Accepted, Verdict::WrongAnswer, Verdict::RuntimeError,
+                      Verdict::TimeLimitExceeded, Verdict::CompileError}) {
+        if (verdictName(c) == s) {
+            v = c;
+            return true;
+        }
+    }
+    return false;
+}
 
 
 // --- Internal File Helpers ---
@@ -36,47 +61,79 @@ namespace {
         return (start == std::string::npos) ? "" : s.substr(start, end - start + 1);
     }
 
-    // 從 CSV 檔案讀取題目資料，並將其存入 problemList
-    void loadProblems(const std::string& csvPath, std::vector<Problem>& problems) {
+    // 轉成一致的路徑表示，讓 "data/problem/a/" 與 "data/problem/a" 視為同一個資料夾
+    std::string normalizePath(const std::string& path) {
+        fs::path p = fs::path(path).lexically_normal();
+        if (!p.has_filename()) p = p.parent_path();
+        return p.generic_string();
+    }
+
+    // 從 CSV 檔案讀取題目資料，並將其存入 problems；無法開啟檔案時回傳 false。
+    // warn 為 false 時不輸出缺少測資的警告 (背景重新載入時使用，避免打斷使用者操作)。
+    bool loadProblems(const std::string& csvPath, std::vector<Problem>& problems, bool warn) {
         problems.clear();
 
         std::ifstream file(csvPath);
         if (!file.is_open()) {
             std::cerr << red("Error: Cannot open problem data file: ") << csvPath << "\n";
-            exit(1);
+            return false;
         }
 
         std::string line;
         while (std::getline(file, line)) {
             if (line.empty()) continue;
             std::stringstream ss(line);
-            std::string title, relativePath;
+            std::string title, relativePath, limit;
             std::getline(ss, title, ',');
             std::getline(ss, relativePath, ',');
+            std::getline(ss, limit, ','); // 選填：時間限制 (ms)
 
             title = trimStr(title);
             relativePath = trimStr(relativePath);
             if (title.empty() || relativePath.empty()) continue;
 
-            fs::path basePath = relativePath;
-            if (!fs::exists(basePath / "testcases")) {
+            fs::path basePath = normalizePath(relativePath);
+            if (warn && !fs::exists(basePath / "testcases")) {
                 std::cerr << yellow("Warning: testcases directory not found for ") << title
                         << " (" << (basePath / "testcases").string() << ")\n";
             }
 
-            problems.emplace_back(title, basePath.string());
+            int limitMs = Problem::DEFAULT_TIME_LIMIT_MS;
+            try {
+                if (!trimStr(limit).empty()) limitMs = std::max(1, std::stoi(trimStr(limit)));
+            } catch (...) {}
+            problems.emplace_back(title, basePath.string(), limitMs);
         }
+        return true;
     }
 
-    // 將新題目寫入 CSV 檔案
-    void appendProblemToCSV(const std::string& csvPath, const std::string& title, const std::string& base) {
-        std::ofstream out(csvPath, std::ios::app);
-        if (!out) {
-            std::cerr << red("Warning: cannot open problem data CSV to append: ") << csvPath << "\n";
-            return;
+    // 先寫到暫存檔再 rename，讀取 problem.csv 的一方不會看到寫到一半的內容
+    bool appendProblemToCSVAtomic(const std::string& csvPath, const std::string& line) {
+        std::string content;
+        {
+            std::ifstream in(csvPath, std::ios::binary);
+            std::stringstream ss;
+            ss << in.rdbuf();
+            content = ss.str();
+        }
+        if (!content.empty() && content.back() != '\n') content += '\n';
+        content += line + "\n";
+
+        std::string tmpPath = csvPath + ".tmp";
+        {
+            std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!(out << content)) return false;
         }
-        out << title << "," << base << "\n";
-        std::cerr << "Writing to: " << fs::absolute(csvPath) << "\n";
+        std::error_code ec;
+        fs::rename(tmpPath, csvPath, ec);
+        return !ec;
+    }
+
+    // 題目標題對應的資料夾，空格替換為 '-'
+    fs::path problemBaseFor(const std::string& title) {
+        std::string folderName = title;
+        std::replace(folderName.begin(), folderName.end(), ' ', '-');
+        return fs::path("data/problem") / folderName;
     }
 
     // 持續讀取使用者輸入並寫入檔案，直到輸入"."為止
@@ -112,88 +169,92 @@ namespace {
 
         std::cout << green("File created: ") << codePath << "\n\n";
     }
+}
 
-    // 編譯程式碼，成功回傳 true
-    bool compileCode(const std::string& codePath) {
-        char cmd[256];
-        snprintf(cmd, sizeof(cmd), COMPILE_CMD, codePath.c_str());
-        return system(cmd) == 0;
-    }
-
-    // 執行程式，使用 input 檔案，回傳是否成功
-    bool runCode(const std::string& inputPath) {
-        char cmd[256];
-        snprintf(cmd, sizeof(cmd), RUN_CMD, inputPath.c_str());
-        return system(cmd) == 0;
-    }
 
-    // 比對實際輸出與預期輸出，逐行檢查
-    bool compareOutput(const std::string& expectedPath, const std::string& actualPath) {
-        std::ifstream expected(expectedPath);
-        std::ifstream actual(actualPath);
-        std::string eLine, aLine;
 
-        while (std::getline(expected, eLine)) {
-            if (!std::getline(actual, aLine) || eLine != aLine)
-                return false;
-        }
-
-        return !std::getline(actual, aLine); // 檢查是否還有額外輸出
+// --- ProblemSystem methods ---
+void ProblemSystem::init(const std::string& problemDataPath) {
+    catalogPath = problemDataPath;
+    auto problems = std::make_shared<ProblemList>();
+    if (!loadProblems(problemDataPath, *problems, true)) exit(1);
+    std::atomic_store(&problemList, std::shared_ptr<const ProblemList>(problems));
+    {
+        std::lock_guard<std::mutex> lock(testdataMutex);
+        testdataCache.clear();
     }
 
-    bool compileAndRun(const std::string& codePath, const std::vector<fs::path>& ins) {
-        std::cout << yellow("Compiling...\n");
-        if (!compileCode(codePath)) {
-            std::cerr << red("Compile error.\n");
-            return false;
-        }
-        bool allPassed = true;
-        for (size_t i = 0; i < ins.size(); ++i) {
-            fs::path inPath = ins[i];
-            fs::path expected = inPath;
-            expected.replace_extension(".out");
-
-            std::cout << yellow("Running test case ") << (i + 1) << "...\n";
-            if (!runCode(inPath.string())) {
-                std::cerr << red("Runtime error on test case ") << (i + 1) << "\n";
-                allPassed = false;
-                break;
-            }
-            if (!compareOutput(expected.string(), "data/user/user_output.txt")) {
-                std::cout << red("Wrong Answer on test case ") << (i + 1) << "\n";
-                allPassed = false;
-                break;
-            } else {
-                std::cout << green("Test case ") << (i + 1) << " passed.\n";
-            }
-        }
-        if (allPassed) std::cout << green("Accepted! All test cases passed.\n");
-        return allPassed;
+    CompileService::instance().warmUp(); // 背景建立預編譯標頭
+    CorePool::instance().calibrate();    // 保留評測核心並校正時間限制倍率
+    SandboxPool::instance().warmUp(CorePool::instance().getCores().size()); // 每個評測核心一個沙箱
+    if (!recorder) {
+        recorder = std::make_shared<TraceRecorder>("data/user/trace.csv", "data/user/trace");
+    }
+    if (!similarity) {
+        similarity = std::make_shared<SimilarityIndex>();
+        similarity->build("data/user/program");
+    }
+    if (!contest) {
+        contest = std::make_shared<Contest>("data/contest");
+        contest->load();
+    }
+    if (!watcher) {
+        // 監看題目清單與測資，變動時在背景套用，不需要重新啟動
+        watcher = std::make_shared<CatalogWatcher>(problemDataPath,
+            [this] {
+                std::vector<std::string> dirs;
+                for (const auto& p : *getProblemList()) dirs.push_back(p.getBasePath());
+                return dirs;
+            },
+            [this] { reloadCatalog(); },
+            [this](const std::string& basePath) { invalidateTestdata(basePath); });
     }
 }
 
+std::shared_ptr<const ProblemList> ProblemSystem::getProblemList() const {
+    return std::atomic_load(&problemList);
+}
 
+// problem.csv 被其他程序修改時重新讀取，並以新的快照替換。
+void ProblemSystem::reloadCatalog() {
+    std::lock_guard<std::mutex> catalogLock(catalogMutex);
+    auto problems = std::make_shared<ProblemList>();
+    if (!loadProblems(catalogPath, *problems, false)) return; // 檔案暫時無法讀取時保留舊的快照
+    std::atomic_store(&problemList, std::shared_ptr<const ProblemList>(problems));
+
+    // 已不在清單中的題目，其測資快取一併移除
+    std::lock_guard<std::mutex> lock(testdataMutex);
+    for (auto it = testdataCache.begin(); it != testdataCache.end(); ) {
+        bool exists = std::any_of(problems->begin(), problems->end(),
+                                  [&](const Problem& p) { return p.getBasePath() == it->first; });
+        it = exists ? std::next(it) : testdataCache.erase(it);
+    }
+}
 
-// --- ProblemSystem methods ---
-void ProblemSystem::init(const std::string& problemDataPath) {
-    loadProblems(problemDataPath, problemList);
+// 題目的測資有變動：丟棄快取，下次評測時重新載入。
+void ProblemSystem::invalidateTestdata(const std::string& basePath) {
+    std::lock_guard<std::mutex> lock(testdataMutex);
+    auto& entry = testdataCache[basePath];
+    entry.generation++;
+    entry.testcases.reset();
 }
 
-bool ProblemSystem::listAllProblems() const {
-    if (problemList.empty()) {
+// 使用者輸入的題號應對照回傳的這份快照，而不是之後重新取得的題目清單。
+std::shared_ptr<const ProblemList> ProblemSystem::listAllProblems() const {
+    auto problems = getProblemList();
+    if (problems->empty()) {
         std::cout << red("No problems found.\n");
-        return false;
+        return nullptr;
     }
     std::cout << cyan("=== Problem List ===\n");
-    for (size_t i = 0; i < problemList.size(); ++i) {
-        std::cout << "[" << i + 1 << "] " << problemList[i].getTitle() << "\n";
+    for (size_t i = 0; i < problems->size(); ++i) {
+        std::cout << "[" << i + 1 << "] " << (*problems)[i].getTitle() << "\n";
     }
-    return true;
+    return problems;
 }
 
-bool ProblemSystem::printProblemDescription(int id) const {
-    if (id < 1 || id > (int)problemList.size()) return false;
-    fs::path descPath = fs::path(problemList[id - 1].getBasePath()) / "description.txt";
+void ProblemSystem::printProblemDescription(const Problem& problem) const {
+    fs::path descPath = fs::path(problem.getBasePath()) / "description.txt";
 
     std::cout << green("\n=== Description ===\n");
     std::ifstream desc(descPath);
@@ -206,21 +267,21 @@ bool ProblemSystem::printProblemDescription(int id) const {
         std::cout << red("Description file not found: ") << descPath.string() << '\n';
     }
     std::cout << green("====================\n");
-    return true;
 }
 
-int ProblemSystem::randomProblem() const {
-    if (problemList.empty()) {
+std::optional<Problem> ProblemSystem::randomProblem() const {
+    auto problems = getProblemList();
+    if (problems->empty()) {
         std::cout << red("No problems available.\n");
-        return -1;
+        return std::nullopt;
     }
     std::mt19937 rng(std::random_device{}());
-    std::uniform_int_distribution<int> dist(0, (int)problemList.size() - 1);
-    int idx = dist(rng);
+    std::uniform_int_distribution<int> dist(0, (int)problems->size() - 1);
+    const Problem& problem = (*problems)[dist(rng)];
 
-    std::cout << yellow("Random Problem: ") << problemList[idx].getTitle() << "\n";
-    printProblemDescription(idx + 1);
-    return idx;
+    std::cout << yellow("Random Problem: ") << problem.getTitle() << "\n";
+    printProblemDescription(problem);
+    return problem;
 }
 
 // 新增一個新的題目集
@@ -233,13 +294,28 @@ void ProblemSystem::newProblemSet(const std::string& problemDataPath) {
         std::cout << red("Title cannot be empty.\n");
         return;
     }
+    if (title.find(',') != std::string::npos) {
+        std::cout << red("Title cannot contain ','.\n");
+        return;
+    }
 
-    std::string folderName = title;
-    std::replace(folderName.begin(), folderName.end(), ' ', '-'); // 將空格替換為 '-'
-
-    fs::path base = fs::path("data/problem") / folderName;
+    fs::path base = problemBaseFor(title);
     fs::path testdir = base / "testcases";
 
+    // 測資量大時可直接從封存檔匯入，不必逐行輸入；封存檔沒有 description.txt 時再詢問敘述
+    std::cout << cyan("Import test cases from a .tar/.tar.gz archive? (y/n): ");
+    if (promptYesNo()) {
+        std::string archivePath;
+        std::cout << yellow("Archive path: ");
+        std::getline(std::cin >> std::ws, archivePath);
+        if (importTestcases(title, archivePath) && !fs::exists(base / "description.txt")) {
+            std::cout << yellow("Enter problem description (end with '.' on a single line):\n");
+            saveInput(base / "description.txt");
+        }
+        return;
+    }
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+
     // 創建資料夾
     try {
         fs::create_directories(testdir);
@@ -266,48 +342,195 @@ void ProblemSystem::newProblemSet(const std::string& problemDataPath) {
         saveInput(testdir / (std::to_string(i) + ".out"));
     }
 
-    // 新增題目到 problemList，將資料寫入 problem.csv
-    addProblem(Problem(title, base.string()));
-    appendProblemToCSV(problemDataPath, title, base.string());
+    // 寫入 problem.csv 後重新載入題目清單 (與匯入相同)
+    {
+        std::lock_guard<std::mutex> lock(catalogMutex);
+        if (!appendProblemToCSVAtomic(problemDataPath, title + "," + base.generic_string())) {
+            std::cout << red("Failed to update ") << problemDataPath << '\n';
+            return;
+        }
+    }
+    reloadCatalog();
     std::cout << green("Problem added: ") << title << '\n';
 }
 
+// 匯入流程：解開到題目資料夾內的暫存資料夾 → 驗證 → 整個替換 testcases → 新題目才寫入 problem.csv。
+// 任何一步失敗都只會留下原本的測資，正在評測的提交也繼續使用它們拿到的快照。
+bool ProblemSystem::importTestcases(const std::string& title, const std::string& archivePath, int timeLimitMs) {
+    if (title.empty() || title.find(',') != std::string::npos) {
+        std::cout << red("Invalid problem title: ") << title << '\n';
+        return false;
+    }
+    auto existing = findProblem(title);
+    fs::path base = existing ? fs::path(existing->getBasePath()) : problemBaseFor(title);
+
+    std::error_code ec;
+    const bool newBase = !fs::exists(base, ec);
+    fs::create_directories(base, ec);
+    fs::path staging = base / (".import-" + std::to_string(std::random_device{}()));
+
+    auto start = std::chrono::steady_clock::now();
+    ImportReport report;
+    std::cout << yellow("Importing ") << archivePath << " into " << base.string() << "...\n";
+    if (!extractTestArchive(archivePath, staging, report)) {
+        fs::remove_all(newBase ? base : staging, ec);
+        std::cout << red("Import failed: ") << report.error << '\n';
+        return false;
+    }
+
+    // description.txt 先移出暫存資料夾 (它不屬於測資)，測資替換成功後才覆蓋原本的敘述
+    fs::path description = staging;
+    description += ".description";
+    if (report.hasDescription) {
+        fs::rename(staging / "description.txt", description, ec);
+    }
+    if (!replaceDirectory(staging, base / "testcases")) {
+        fs::remove_all(newBase ? base : staging, ec);
+        fs::remove(description, ec);
+        std::cout << red("Import failed: cannot replace ") << (base / "testcases").string() << '\n';
+        return false;
+    }
+    if (report.hasDescription) {
+        fs::rename(description, base / "description.txt", ec);
+    }
+    invalidateTestdata(normalizePath(base.string()));
+
+    if (!existing) {
+        std::string line = title + "," + base.generic_string();
+        if (timeLimitMs > 0) line += "," + std::to_string(timeLimitMs);
+        {
+            std::lock_guard<std::mutex> lock(catalogMutex);
+            if (!appendProblemToCSVAtomic(catalogPath, line)) {
+                std::cout << red("Import failed: cannot update ") << catalogPath << '\n';
+                return false;
+            }
+        }
+        reloadCatalog();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    char summary[128];
+    snprintf(summary, sizeof(summary), " test cases (%.1f MB) into ", report.bytes / (1024.0 * 1024.0));
+    std::cout << green("Imported ") << report.cases << summary << title;
+    snprintf(summary, sizeof(summary), " in %.2f s", seconds);
+    std::cout << summary;
+    if (report.skipped) std::cout << ", skipped " << report.skipped << " other files";
+    std::cout << '\n';
+    return true;
+}
+
+std::optional<Problem> ProblemSystem::findProblem(const std::string& title) const {
+    auto problems = getProblemList();
+    for (const auto& problem : *problems) {
+        if (problem.getTitle() == title) return problem;
+    }
+    return std::nullopt;
+}
+
+// 複製目前的快照、加入新題目後再整份替換 (copy-on-write)。
 void ProblemSystem::addProblem(const Problem& p) {
-    problemList.push_back(p);
+    std::lock_guard<std::mutex> lock(catalogMutex);
+    auto problems = std::make_shared<ProblemList>(*getProblemList());
+    problems->emplace_back(p.getTitle(), normalizePath(p.getBasePath()), p.getTimeLimitMs());
+    std::atomic_store(&problemList, std::shared_ptr<const ProblemList>(problems));
 }
 
-std::vector<fs::path> ProblemSystem::testcasePrepare(const int id) {
-    if (id < 1 || id > (int)problemList.size()) {
-        std::cout << red("Invalid problem id.\n");
-        return {};
+// 取得題目目前的測資快照；快取中沒有時才從磁碟載入所有 .in/.out。
+std::shared_ptr<const TestcaseSet> ProblemSystem::testcasePrepare(const Problem& problem) {
+    const std::string basePath = problem.getBasePath();
+    unsigned long long generation;
+    {
+        std::lock_guard<std::mutex> lock(testdataMutex);
+        auto& entry = testdataCache[basePath];
+        if (entry.testcases) return entry.testcases;
+        generation = entry.generation;
     }
 
-    const auto& prob = problemList[id - 1];
-    fs::path tcDir = fs::path(prob.getBasePath()) / "testcases";
-    if (!fs::exists(tcDir) || !fs::is_directory(tcDir)) {
+    fs::path tcDir = fs::path(basePath) / "testcases";
+    std::error_code ec;
+    if (!fs::exists(tcDir, ec) || !fs::is_directory(tcDir, ec)) {
         std::cerr << red("Testcases directory missing: ") << tcDir.string() << '\n';
-        return {};
+        return nullptr;
     }
 
     std::vector<fs::path> ins;
-    for (auto &entry : fs::directory_iterator(tcDir)) {
+    for (auto &entry : fs::directory_iterator(tcDir, ec)) {
         if (entry.path().extension() == ".in") ins.push_back(entry.path());
     }
     if (ins.empty()) {
         std::cerr << red("No .in testcases found.\n");
-        return {};
+        return nullptr;
     }
     std::sort(ins.begin(), ins.end());
-    return ins;
+
+    // 所有 .in/.out 一次批次讀入 (io_uring 可用時只需少量系統呼叫)
+    std::vector<fs::path> paths;
+    for (const auto& inPath : ins) {
+        fs::path outPath = inPath;
+        outPath.replace_extension(".out");
+        paths.push_back(inPath);
+        paths.push_back(outPath);
+    }
+    std::vector<std::string> contents = readFiles(paths);
+
+    auto testcases = std::make_shared<TestcaseSet>();
+    for (size_t i = 0; i < ins.size(); ++i) {
+        testcases->push_back({ins[i].stem().string(),
+                              std::make_shared<const std::string>(std::move(contents[2 * i])),
+                              std::make_shared<const std::string>(std::move(contents[2 * i + 1]))});
+    }
+
+    // 載入期間若測資又被修改 (generation 改變)，這份結果仍可供本次評測使用，但不放入快取。
+    std::lock_guard<std::mutex> lock(testdataMutex);
+    auto& entry = testdataCache[basePath];
+    if (entry.generation == generation) entry.testcases = testcases;
+    return testcases;
+}
+
+
+// 交給共用的 JudgePipeline 評測並等待結果。多個提交同時進行時，
+// 一份的編譯可以與另一份的執行重疊，同時編譯的數量也受同一個上限控制。
+Verdict ProblemSystem::judgeOnPipeline(const std::string& codePath, std::shared_ptr<const TestcaseSet> testcases,
+                                       int timeLimitMs, bool verbose, size_t* passed) {
+    std::future<std::pair<Verdict, size_t>> result;
+    size_t id = 0;
+    {
+        std::lock_guard<std::mutex> lock(judgeMutex);
+        if (!pipeline) {
+            pipeline = std::make_shared<JudgePipeline>([this](size_t doneId, Verdict verdict, size_t passedCount) {
+                std::promise<std::pair<Verdict, size_t>> promise;
+                {
+                    std::lock_guard<std::mutex> lock(judgeMutex);
+                    auto it = pendingJudges.find(doneId);
+                    promise = std::move(it->second);
+                    pendingJudges.erase(it);
+                }
+                promise.set_value({verdict, passedCount});
+            });
+        }
+        id = nextJudgeId++;
+        result = pendingJudges[id].get_future();
+    }
+    pipeline->submit({id, codePath, std::move(testcases), timeLimitMs, verbose, passed != nullptr});
+
+    auto [verdict, passedCount] = result.get();
+    if (passed) *passed = passedCount;
+    return verdict;
 }
 
+// 對指定題目評測一份程式碼；測資缺失時視為 Runtime Error。
+Verdict ProblemSystem::judge(const Problem& problem, const std::string& codePath, bool verbose) {
+    auto testcases = testcasePrepare(problem);
+    if (!testcases) return Verdict::RuntimeError;
+    return judgeOnPipeline(codePath, std::move(testcases), problem.getTimeLimitMs(), verbose);
+}
 
-void ProblemSystem::submitCode(const int id) {
+Verdict ProblemSystem::submitCode(const Problem& problem, const std::string& username) {
     // 檢查測資，若準備失敗則終止流程
-    auto ins = testcasePrepare(id);
-    if (ins.empty()) return;
+    if (!testcasePrepare(problem)) return Verdict::RuntimeError;
 
     std::string codePath;
+    Verdict verdict = Verdict::CompileError;
     while (true) {
         std::string input;
         while (true) {
@@ -319,7 +542,25 @@ void ProblemSystem::submitCode(const int id) {
         }
 
         codePath = "data/user/program/" + input;
-        if (compileAndRun(codePath, ins)) break; // 若成功通過測資，則結束流程
+        auto arrival = std::chrono::system_clock::now();
+        // 每次提交都取得當下的測資快照；評測途中測資被修改也不影響本次結果
+        auto testcases = testcasePrepare(problem);
+        if (!testcases) return Verdict::RuntimeError;
+        // 比賽進行中的題目：以送出的時間計分，IOI 模式需要統計通過的測資數
+        long long arrivalSec = std::chrono::duration_cast<std::chrono::seconds>(arrival.time_since_epoch()).count();
+        bool scored = contest && contest->isRunning(arrivalSec) && contest->hasProblem(problem.getTitle());
+        size_t passed = 0;
+        bool partial = scored && contest->getConfig().mode == ContestMode::IOI;
+        verdict = judgeOnPipeline(codePath, testcases, problem.getTimeLimitMs(), true, partial ? &passed : nullptr);
+        if (recorder) recorder->record(arrival, username, problem.getTitle(), codePath, verdict);
+        if (scored && contest->submit(username, problem.getTitle(), verdict, passed, testcases->size(), arrivalSec)) {
+            std::cout << cyan("Counted for contest: ") << contest->getConfig().name << std::endl;
+        } else if (scored) {
+            std::cerr << red("Warning: this submission could not be recorded for the contest.\n");
+        }
+        // 與歷史提交比對，相似的配對記錄到報告檔 (不顯示給提交者)
+        if (similarity) appendSimilarityReport("data/user/similarity_report.csv", similarity->add(codePath));
+        if (verdict == Verdict::Accepted) break; // 若成功通過測資，則結束流程
 
         std::cout << yellow("\nRetry? (y/n): ");
         if (!promptYesNo()) {
@@ -327,4 +568,5 @@ void ProblemSystem::submitCode(const int id) {
             break;
         }
     }
+    return verdict;
 }
@@ -0,0 +1,359 @@
+// Runner.cpp
+
+#include "Runner.hpp"
+#include "Compiler.hpp"
+#include "Cpu.hpp"
+#include "AsyncIo.hpp"
+#include "Sandbox.hpp"
+#include "ColorPrint.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cstdio>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#ifdef _WIN32
+#define RUN_CMD "\"%s\" < \"%s\" > \"%s\""
+#else
+#include <sched.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#endif
+
+// --- Internal helpers ---
+namespace {
+#ifdef _WIN32
+    // 轉成目前平台的路徑格式 (Windows 使用 '\\')
+    std::string nativePath(const std::string& path) {
+        return fs::path(path).make_preferred().string();
+    }
+
+    std::string readOutputFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream ss;
+        ss << file.rdbuf();
+        return ss.str();
+    }
+#else
+    // 等待子程序結束，最多等到 deadline；逾時則強制結束。回傳是否逾時。
+    // 優先使用 pidfd + poll 精確等待，核心不支援時退回逐步拉長間隔的輪詢。
+    bool waitChild(pid_t pid, std::chrono::steady_clock::time_point deadline, int& status, rusage& usage) {
+        using Clock = std::chrono::steady_clock;
+        int pidfd = -1;
+#ifdef SYS_pidfd_open
+        pidfd = (int)syscall(SYS_pidfd_open, pid, 0);
+#endif
+        auto backoff = std::chrono::microseconds(50);
+        bool timedOut = false;
+        while (wait4(pid, &status, WNOHANG, &usage) == 0) {
+            auto now = Clock::now();
+            if (now >= deadline) {
+                kill(pid, SIGKILL);
+                wait4(pid, &status, 0, &usage);
+                timedOut = true;
+                break;
+            }
+            if (pidfd >= 0) {
+                pollfd pfd{pidfd, POLLIN, 0};
+                auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count();
+                poll(&pfd, 1, (int)std::max<long long>(1, remaining));
+            } else {
+                std::this_thread::sleep_for(backoff);
+                backoff = std::min(backoff * 2, std::chrono::microseconds(2000));
+            }
+        }
+        if (pidfd >= 0) close(pidfd);
+        return timedOut;
+    }
+
+    // 依結束狀態與 CPU 時間判定結果 (沙箱與直接 fork 兩種方式共用)
+    RunResult classifyRun(bool timedOut, bool overflow, int status, double cpuMs, double limitMs, std::string output) {
+        if (overflow) return {RunStatus::RuntimeError, cpuMs, ""}; // 輸出超過上限
+        if (timedOut || cpuMs > limitMs || (WIFSIGNALED(status) && WTERMSIG(status) == SIGXCPU)) {
+            return {RunStatus::TimeLimitExceeded, cpuMs, ""};
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) return {RunStatus::RuntimeError, cpuMs, ""};
+        return {RunStatus::Ok, cpuMs, std::move(output)};
+    }
+#endif
+}
+
+// 編譯程式碼，成功回傳 true (透過 CompileService 使用 PCH 與編譯快取)
+bool compileCode(const std::string& codePath, const RunTarget& target) {
+    return CompileService::instance().compile(codePath, target.binaryPath);
+}
+
+// 執行程式並回傳其標準輸出。
+// POSIX：在借來的沙箱 (沙箱停用時為直接 fork 的子程序) 中綁定到借來的核心，並以 setrlimit 限制 CPU 時間；stdin/stdout 接到 pipe，
+// 由 pumpPipes (io_uring) 同時寫入測資與讀取輸出，整個過程不經過檔案系統。
+// 以 wait4 取得該子程序自己的 CPU 時間，不受同時執行的其他程式影響。
+RunResult runCode(const RunTarget& target, const std::string& input, int timeLimitMs) {
+    CorePool& corePool = CorePool::instance();
+    const double limitMs = timeLimitMs * corePool.timeScale();
+    CoreLease core = corePool.acquire();
+
+    // 執行檔一定帶有目錄，避免從 PATH 中尋找同名程式
+    std::string binary = fs::path(target.binaryPath).has_parent_path()
+                       ? target.binaryPath : "./" + target.binaryPath;
+#ifdef _WIN32
+    {
+        std::ofstream inputFile(target.inputPath, std::ios::binary | std::ios::trunc);
+        inputFile << input;
+    }
+    char cmd[1024];
+    snprintf(cmd, sizeof(cmd), RUN_CMD, nativePath(binary).c_str(), nativePath(target.inputPath).c_str(),
+             nativePath(target.outputPath).c_str());
+    auto start = std::chrono::steady_clock::now();
+    bool ok = system(cmd) == 0;
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (!ok) return {RunStatus::RuntimeError, elapsedMs, ""};
+    return {elapsedMs > limitMs ? RunStatus::TimeLimitExceeded : RunStatus::Ok, elapsedMs,
+            readOutputFile(target.outputPath)};
+#else
+    // 受測程式提早結束時寫入 stdin 會觸發 SIGPIPE，評測程式本身改為收到 EPIPE
+    static const bool sigpipeIgnored = (signal(SIGPIPE, SIG_IGN), true);
+    (void)sigpipeIgnored;
+
+    // 牆上時間保護：程式卡在 I/O 或 sleep 時不會消耗 CPU 時間，仍需在合理時間內結束
+    auto deadline = std::chrono::steady_clock::now()
+                  + std::chrono::milliseconds((long long)(limitMs * 2) + 1000);
+    const rlim_t cpuLimitSec = (rlim_t)(limitMs / 1000) + 1;
+
+    // 沙箱啟用時一律在預先建立好的沙箱中執行，不會退回直接 fork (否則故障時受測程式就在隔離之外執行)。
+    // 受測程式開始執行前的故障換一個沙箱重試一次；其餘故障或借不到沙箱時以 Runtime Error 計
+    SandboxPool& sandboxPool = SandboxPool::instance();
+    if (sandboxPool.enabled()) {
+        SandboxRequest request;
+        request.binaryPath = fs::absolute(binary).lexically_normal().string();
+        request.cpu = core.get();
+        request.cpuLimitSec = cpuLimitSec;
+        request.fileLimitBytes = (unsigned long long)WorkspacePool::OUTPUT_LIMIT_BYTES;
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            SandboxLease sandbox = sandboxPool.acquire();
+            if (!sandbox) break;
+            SandboxResult result = sandbox.run(request, input, deadline);
+            if (result.ok) {
+                return classifyRun(result.timedOut, result.overflow, result.status, result.cpuMs, limitMs,
+                                   std::move(result.output));
+            }
+            if (!result.retryable) break;
+        }
+        return {RunStatus::RuntimeError, 0, ""};
+    }
+
+    // fork 之後子程序只能呼叫 async-signal-safe 的函式，所需資料都先準備好
+    const char* argv[] = {binary.c_str(), nullptr};
+    rlimit cpuLimit;
+    cpuLimit.rlim_cur = cpuLimitSec;
+    cpuLimit.rlim_max = cpuLimit.rlim_cur + 1;
+    rlimit fileLimit;
+    fileLimit.rlim_cur = fileLimit.rlim_max = (rlim_t)WorkspacePool::OUTPUT_LIMIT_BYTES;
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    if (core.get() >= 0) CPU_SET(core.get(), &cpuSet);
+
+    int stdinPipe[2], stdoutPipe[2];
+    if (pipe2(stdinPipe, O_CLOEXEC) != 0) return {RunStatus::RuntimeError, 0, ""};
+    if (pipe2(stdoutPipe, O_CLOEXEC) != 0) {
+        close(stdinPipe[0]);
+        close(stdinPipe[1]);
+        return {RunStatus::RuntimeError, 0, ""};
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        for (int fd : {stdinPipe[0], stdinPipe[1], stdoutPipe[0], stdoutPipe[1]}) close(fd);
+        return {RunStatus::RuntimeError, 0, ""};
+    }
+    if (pid == 0) {
+        if (core.get() >= 0) sched_setaffinity(0, sizeof(cpuSet), &cpuSet);
+        // dup2 得到的 fd 不帶 O_CLOEXEC，其餘 pipe 端點在 exec 時自動關閉
+        dup2(stdinPipe[0], STDIN_FILENO);
+        dup2(stdoutPipe[1], STDOUT_FILENO);
+        signal(SIGPIPE, SIG_DFL);
+        setrlimit(RLIMIT_CPU, &cpuLimit);
+        setrlimit(RLIMIT_FSIZE, &fileLimit);
+        execv(argv[0], const_cast<char* const*>(argv));
+        _exit(127);
+    }
+    close(stdinPipe[0]);
+    close(stdoutPipe[1]);
+
+    PipeResult io = pumpPipes(stdinPipe[1], stdoutPipe[0], input,
+                              (size_t)WorkspacePool::OUTPUT_LIMIT_BYTES, deadline);
+    if (io.timedOut || io.overflow || io.ioError) kill(pid, SIGKILL);
+
+    int status = 0;
+    rusage usage{};
+    bool timedOut = waitChild(pid, deadline, status, usage) || io.timedOut;
+
+    double cpuMs = usage.ru_utime.tv_sec * 1000.0 + usage.ru_utime.tv_usec / 1000.0
+                 + usage.ru_stime.tv_sec * 1000.0 + usage.ru_stime.tv_usec / 1000.0;
+    // 評測端 I/O 失敗時輸出不完整，與輸出超過上限同樣視為 Runtime Error
+    return classifyRun(timedOut, io.overflow || io.ioError, status, cpuMs, limitMs, std::move(io.output));
+#endif
+}
+
+// 比對實際輸出與預期輸出 (皆已在記憶體中)，逐行檢查
+bool compareOutput(const std::string& expectedContent, const std::string& actualContent) {
+    std::istringstream expected(expectedContent);
+    std::istringstream actual(actualContent);
+    std::string eLine, aLine;
+
+    while (std::getline(expected, eLine)) {
+        if (!std::getline(actual, aLine) || eLine != aLine)
+            return false;
+    }
+
+    return !std::getline(actual, aLine); // 檢查是否還有額外輸出
+}
+
+// 測資內容來自評測開始時的快照，直接從記憶體餵給受測程式。
+Verdict runTestcases(const RunTarget& target, const TestcaseSet& testcases, int timeLimitMs, bool verbose,
+                     size_t* passed) {
+    Verdict verdict = Verdict::Accepted;
+    if (passed) *passed = 0;
+    for (size_t i = 0; i < testcases.size(); ++i) {
+        const Testcase& tc = testcases[i];
+
+        if (verbose) std::cout << yellow("Running test case ") << (i + 1) << "...\n";
+        RunResult result = runCode(target, *tc.input, timeLimitMs);
+        Verdict caseVerdict = Verdict::Accepted;
+        if (result.status == RunStatus::TimeLimitExceeded) {
+            if (verbose) std::cout << red("Time Limit Exceeded on test case ") << (i + 1) << "\n";
+            caseVerdict = Verdict::TimeLimitExceeded;
+        } else if (result.status == RunStatus::RuntimeError) {
+            if (verbose) std::cerr << red("Runtime error on test case ") << (i + 1) << "\n";
+            caseVerdict = Verdict::RuntimeError;
+        } else if (!compareOutput(*tc.expected, result.output)) {
+            if (verbose) std::cout << red("Wrong Answer on test case ") << (i + 1) << "\n";
+            caseVerdict = Verdict::WrongAnswer;
+        } else if (verbose) {
+            std::cout << green("Test case ") << (i + 1) << " passed. (" << (int)result.cpuMs << " ms)\n";
+        }
+
+        if (caseVerdict == Verdict::Accepted) {
+            if (passed) ++*passed;
+            continue;
+        }
+        if (verdict == Verdict::Accepted) verdict = caseVerdict;
+        if (!passed) return verdict; // 不需要部分給分時，第一筆失敗就結束
+    }
+    if (verbose && verdict == Verdict::Accepted) std::cout << green("Accepted! All test cases passed.\n");
+    if (verbose && passed) std::cout << yellow("Passed ") << *passed << " / " << testcases.size() << " test cases.\n";
+    return verdict;
+}
+
+// 編譯並逐一執行測資，回傳判題結果。verbose 為 false 時不輸出過程 (供重播等批次工作使用)。
+Verdict compileAndRun(const std::string& codePath, const TestcaseSet& testcases, int timeLimitMs, bool verbose,
+                      size_t* passed) {
+    if (passed) *passed = 0;
+    WorkspaceLease workspace = WorkspacePool::instance().acquire();
+    if (verbose) std::cout << yellow("Compiling...\n");
+    if (!compileCode(codePath, workspace.target())) {
+        if (verbose) std::cerr << red("Compile error.\n");
+        return Verdict::CompileError;
+    }
+    return runTestcases(workspace.target(), testcases, timeLimitMs, verbose, passed);
+}
+
+
+// --- JudgePipeline ---
+JudgePipeline::JudgePipeline(Callback onDone, size_t workerCount, size_t queueCapacity) : onDone(std::move(onDone)) {
+    const CorePool& corePool = CorePool::instance();
+    compileLimit = std::max<size_t>(corePool.getHousekeeping().size(), 1);
+    if (workerCount == 0) workerCount = corePool.getCores().size() + compileLimit;
+    if (queueCapacity == 0) queueCapacity = workerCount;
+    this->queueCapacity = std::max<size_t>(queueCapacity, 1);
+    workerCount = std::max<size_t>(workerCount, 1);
+    for (size_t i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&JudgePipeline::workerLoop, this);
+    }
+}
+
+JudgePipeline::~JudgePipeline() {
+    finish();
+}
+
+void JudgePipeline::submit(JudgeJob job) {
+    std::unique_lock<std::mutex> lock(mutex);
+    spaceAvailable.wait(lock, [this] { return compileQueue.size() < queueCapacity; });
+    compileQueue.push_back(std::move(job));
+    workAvailable.notify_one();
+}
+
+void JudgePipeline::finish() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+    }
+    workAvailable.notify_all();
+    for (auto& worker : workers) worker.join();
+    workers.clear();
+}
+
+// 每個 worker 優先執行已編譯好的程式，讓 runQueue 保持有空位；
+// 只有在 runQueue 還放得下時才會從 compileQueue 取出新的提交編譯。
+void JudgePipeline::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto canCompile = [this] {
+        return !compileQueue.empty() && compiling < compileLimit && runQueue.size() + compiling < queueCapacity;
+    };
+
+    while (true) {
+        workAvailable.wait(lock, [&] {
+            return !runQueue.empty() || canCompile() || (closed && compileQueue.empty() && compiling == 0);
+        });
+
+        if (!runQueue.empty()) {
+            CompiledJob compiled = std::move(runQueue.front());
+            runQueue.pop_front();
+            size_t index = compiled.job.index;
+            lock.unlock();
+
+            size_t passed = 0;
+            Verdict verdict = runTestcases(compiled.workspace.target(), *compiled.job.testcases, compiled.job.timeLimitMs,
+                                           compiled.job.verbose, compiled.job.partial ? &passed : nullptr);
+            compiled.workspace.release(); // 先歸還工作區再通知呼叫端
+            onDone(index, verdict, passed);
+
+            lock.lock();
+            workAvailable.notify_all(); // runQueue 有空位了，其他 worker 可以繼續編譯
+            continue;
+        }
+
+        if (canCompile()) {
+            JudgeJob job = std::move(compileQueue.front());
+            compileQueue.pop_front();
+            compiling++;
+            spaceAvailable.notify_one();
+            lock.unlock();
+
+            WorkspaceLease workspace = WorkspacePool::instance().acquire();
+            if (job.verbose) std::cout << yellow("Compiling...\n");
+            bool compiled = compileCode(job.codePath, workspace.target());
+            if (!compiled) {
+                if (job.verbose) std::cerr << red("Compile error.\n");
+                workspace.release();
+                onDone(job.index, Verdict::CompileError, 0);
+            }
+
+            lock.lock();
+            compiling--;
+            if (compiled) runQueue.push_back({std::move(job), std::move(workspace)});
+            workAvailable.notify_all();
+            continue;
+        }
+
+        return; // 已關閉且沒有剩餘工作
+    }
+}
@@ -0,0 +1,788 @@
+// Sandbox.cpp
+
+#include "Sandbox.hpp"
+#include "AsyncIo.hpp"
+#include "Workspace.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+
+#ifdef __linux__
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mount.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// --- Internal helpers ---
+namespace {
+    bool envDisabled(const char* name) {
+        const char* value = std::getenv(name);
+        return value && std::string(value) == "0";
+    }
+
+#ifdef __linux__
+    constexpr int INIT_SOCK_FD = 3;   // 沙箱 init 啟動時 socket 固定放在 fd 3
+    constexpr int MAX_PASSED_FDS = 3; // 一次請求附帶的 fd：執行檔、stdin、stdout
+    constexpr int SANDBOX_PIDS_MAX = 64; // 每個沙箱的程序數上限，擋下 fork bomb
+
+    // 判題系統 -> 沙箱 init
+    struct InitRequest {
+        char type;                    // 'X' 執行、'K' 強制結束目前的程式
+        int cpu;
+        unsigned long long cpuLimitSec;
+        unsigned long long fileLimitBytes;
+    };
+
+    // 沙箱 init -> 判題系統
+    struct InitReply {
+        char type;                    // 'R' 準備完成、'E' 建立失敗、'D' 執行結束
+        int status;
+        long long cpuUs;              // 受測程式的 user + sys 時間
+        char message[256];
+    };
+
+    bool sendMessage(int sock, const void* data, size_t size, const int* fds = nullptr, int fdCount = 0) {
+        iovec iov{const_cast<void*>(data), size};
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * MAX_PASSED_FDS)];
+        if (fdCount > 0) {
+            msg.msg_control = control;
+            msg.msg_controllen = CMSG_SPACE(sizeof(int) * fdCount);
+            cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fdCount);
+            std::memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * fdCount);
+        }
+        while (true) {
+            ssize_t n = sendmsg(sock, &msg, MSG_NOSIGNAL);
+            if (n == (ssize_t)size) return true;
+            if (n < 0 && errno == EINTR) continue;
+            return false;
+        }
+    }
+
+    // 回傳讀到的位元組數，對方關閉時回傳 0；收到的 fd 依序放進 fds
+    ssize_t receiveMessage(int sock, void* data, size_t size, int* fds = nullptr, int* fdCount = nullptr) {
+        iovec iov{data, size};
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * MAX_PASSED_FDS)];
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        ssize_t n;
+        do {
+            n = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+        } while (n < 0 && errno == EINTR);
+
+        int received = 0;
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); n >= 0 && cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) continue;
+            int count = (int)((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+            for (int i = 0; i < count; ++i) {
+                int fd;
+                std::memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+                if (fds && received < MAX_PASSED_FDS) fds[received++] = fd;
+                else close(fd);
+            }
+        }
+        if (fdCount) *fdCount = received;
+        return n;
+    }
+
+    // 等待 socket 可讀，最多到 deadline；回傳是否可讀
+    bool waitReadable(int sock, std::chrono::steady_clock::time_point deadline) {
+        while (true) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            pollfd pfd{sock, POLLIN, 0};
+            int ready = poll(&pfd, 1, (int)std::max<long long>(0, remaining));
+            if (ready > 0) return true;
+            if (ready == 0) return false;
+            if (errno != EINTR) return false;
+        }
+    }
+
+    bool writeFile(const std::string& path, const std::string& content) {
+        int fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        bool ok = write(fd, content.data(), content.size()) == (ssize_t)content.size();
+        close(fd);
+        return ok;
+    }
+
+    // 目前程序所在的 cgroup v2 資料夾；系統沒有掛載 cgroup2 時回傳空字串
+    std::string currentCgroupDir() {
+        std::string mountPoint;
+        std::ifstream mountInfo("/proc/self/mountinfo");
+        std::string line;
+        while (std::getline(mountInfo, line)) {
+            size_t sep = line.find(" - ");
+            if (sep == std::string::npos || line.compare(sep + 3, 8, "cgroup2 ") != 0) continue;
+            std::istringstream fields(line);
+            std::string field;
+            for (int i = 0; i < 5 && fields >> field; ++i) {}
+            mountPoint = field;
+            break;
+        }
+        if (mountPoint.empty()) return "";
+
+        std::ifstream cgroupFile("/proc/self/cgroup");
+        while (std::getline(cgroupFile, line)) {
+            if (line.rfind("0::", 0) == 0) {
+                std::string path = line.substr(3);
+                return path == "/" ? mountPoint : mountPoint + path;
+            }
+        }
+        return "";
+    }
+
+    // 清除先前異常結束的判題程序留下的 cgroup
+    void removeStaleCgroups(const std::string& parent) {
+        std::error_code ec;
+        for (auto& entry : fs::directory_iterator(parent, ec)) {
+            std::string name = entry.path().filename().string();
+            if (name.rfind("judge-", 0) != 0 || !entry.is_directory(ec)) continue;
+            std::string pid = name.substr(6);
+            if (pid.empty() || pid.find_first_not_of("0123456789") != std::string::npos) continue;
+            if (fs::exists("/proc/" + pid, ec)) continue;
+            for (auto& leaf : fs::directory_iterator(entry.path(), ec)) {
+                if (leaf.is_directory(ec)) rmdir(leaf.path().c_str());
+            }
+            rmdir(entry.path().c_str());
+        }
+    }
+
+    // cgroup 中是否列出 controller；file 為 "cgroup.controllers" (可用) 或 "cgroup.subtree_control" (已為子 cgroup 開啟)
+    bool hasController(const std::string& cgroup, const char* file, const std::string& controller) {
+        std::ifstream list(cgroup + "/" + file);
+        std::string name;
+        while (list >> name) {
+            if (name == controller) return true;
+        }
+        return false;
+    }
+
+    // 在判題程序所在的 cgroup 下建立 judge-<pid>，只在這個自己的子樹內為 leaf 開啟 memory/pids controller。
+    // 上層 cgroup 的設定不會更動：上層沒有把 controller 交給 judge-<pid> 時就沒有該項限制，
+    // 實際開啟了哪些由呼叫端以 hasController 確認。沒有權限建立時回傳空字串 (沙箱仍可運作，只是沒有資源限制)。
+    std::string createCgroupRoot() {
+        std::string parent = currentCgroupDir();
+        if (parent.empty() || access(parent.c_str(), W_OK) != 0) return "";
+        removeStaleCgroups(parent);
+
+        std::string root = parent + "/judge-" + std::to_string(getpid());
+        if (mkdir(root.c_str(), 0755) != 0 && errno != EEXIST) return "";
+        for (const char* controller : {"memory", "pids"}) {
+            if (hasController(root, "cgroup.controllers", controller)) {
+                writeFile(root + "/cgroup.subtree_control", std::string("+") + controller);
+            }
+        }
+        return root;
+    }
+
+    void removeCgroup(const std::string& path) {
+        if (path.empty()) return;
+        writeFile(path + "/cgroup.kill", "1");
+        // 程序結束後 cgroup 才能刪除，稍等一下
+        for (int attempt = 0; attempt < 100 && rmdir(path.c_str()) != 0 && errno == EBUSY; ++attempt) {
+            usleep(1000);
+        }
+    }
+
+    // --- 以下在沙箱 init 中執行 ---
+
+    // 確認是由 SandboxPool::spawn 建立的：新 pid namespace 的 PID 1 (父程序在 namespace 之外)、
+    // user namespace 只對應了一個 uid，且 fd 3 是 spawn 留下的 SOCK_SEQPACKET。
+    // 任何一項不符就不碰掛載，避免有人手動執行 --sandbox-init 改到主機的 mount namespace。
+    bool spawnedBySandboxPool() {
+        if (getpid() != 1 || getppid() != 0) return false;
+
+        std::ifstream uidMap("/proc/self/uid_map");
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(uidMap, line); ) lines.push_back(line);
+        if (lines.size() != 1) return false;
+        std::istringstream fields(lines[0]);
+        unsigned long long inside = 0, outside = 0, count = 0;
+        if (!(fields >> inside >> outside >> count) || inside != 0 || count != 1) return false;
+
+        int type = 0;
+        socklen_t length = sizeof(type);
+        return getsockopt(INIT_SOCK_FD, SOL_SOCKET, SO_TYPE, &type, &length) == 0 && type == SOCK_SEQPACKET;
+    }
+
+    [[noreturn]] void initFail(const char* what) {
+        InitReply reply{};
+        reply.type = 'E';
+        snprintf(reply.message, sizeof(reply.message), "%s: %s", what, strerror(errno));
+        sendMessage(INIT_SOCK_FD, &reply, sizeof(reply));
+        _exit(1);
+    }
+
+    // 重新掛載時必須保留原本被鎖定的旗標 (nosuid、noexec、atime...)，否則在 user namespace 中會被拒絕
+    unsigned long lockedFlags(const char* path) {
+        struct statvfs st{};
+        if (statvfs(path, &st) != 0) return 0;
+        unsigned long flags = 0;
+        if (st.f_flag & ST_NOSUID) flags |= MS_NOSUID;
+        if (st.f_flag & ST_NODEV) flags |= MS_NODEV;
+        if (st.f_flag & ST_NOEXEC) flags |= MS_NOEXEC;
+        if (st.f_flag & ST_NOATIME) flags |= MS_NOATIME;
+        if (st.f_flag & ST_NODIRATIME) flags |= MS_NODIRATIME;
+        if (st.f_flag & ST_RELATIME) flags |= MS_RELATIME;
+        return flags;
+    }
+
+    // 將主機上的路徑以相同路徑放進新的根目錄；readOnly 時重新掛載為唯讀
+    void bindIntoRoot(const std::string& root, const std::string& hostPath, bool readOnly) {
+        struct stat st{};
+        if (lstat(hostPath.c_str(), &st) != 0) return; // 主機上沒有就略過
+        std::string inside = root + hostPath;
+        std::error_code ec;
+        fs::create_directories(fs::path(inside).parent_path(), ec);
+
+        if (S_ISLNK(st.st_mode)) {
+            // merged /usr 的 /lib -> usr/lib 等連結原樣複製
+            char target[4096];
+            ssize_t n = readlink(hostPath.c_str(), target, sizeof(target) - 1);
+            if (n < 0) initFail("readlink");
+            target[n] = '\0';
+            if (symlink(target, inside.c_str()) != 0) initFail("symlink");
+            return;
+        }
+        if (S_ISDIR(st.st_mode)) {
+            fs::create_directories(inside, ec);
+        } else {
+            int fd = open(inside.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+            if (fd < 0) initFail("create mount point");
+            close(fd);
+        }
+        if (mount(hostPath.c_str(), inside.c_str(), nullptr, MS_BIND, nullptr) != 0) initFail("bind mount");
+        if (readOnly) {
+            unsigned long flags = MS_BIND | MS_REMOUNT | MS_RDONLY | MS_NOSUID | lockedFlags(inside.c_str());
+            if (mount(nullptr, inside.c_str(), nullptr, flags, nullptr) != 0) initFail("remount read-only");
+        }
+    }
+
+    // 最小的根目錄：唯讀的 tmpfs，只放入執行 C++ 程式需要的系統函式庫與幾個裝置檔。
+    // 工作區不放進沙箱：受測程式的執行檔由判題系統開啟後以 fd 傳入，沙箱內看不到其他提交的執行檔與輸出。
+    void setupRoot(const std::string& root) {
+        if (mount(nullptr, "/", nullptr, MS_REC | MS_PRIVATE, nullptr) != 0) initFail("make mounts private");
+        if (mount("tmpfs", root.c_str(), "tmpfs", MS_NOSUID | MS_NODEV, "size=1m,mode=0755") != 0) initFail("mount tmpfs");
+
+        for (const char* path : {"/usr", "/bin", "/lib", "/lib32", "/lib64", "/libx32", "/etc/ld.so.cache"}) {
+            bindIntoRoot(root, path, true);
+        }
+        for (const char* device : {"/dev/null", "/dev/zero", "/dev/random", "/dev/urandom"}) {
+            bindIntoRoot(root, device, false);
+        }
+
+        if (chdir(root.c_str()) != 0) initFail("chdir");
+        if (syscall(SYS_pivot_root, ".", ".") != 0) initFail("pivot_root");
+        if (umount2(".", MNT_DETACH) != 0) initFail("detach old root");
+        if (chdir("/") != 0) initFail("chdir");
+        if (mount(nullptr, "/", nullptr, MS_REMOUNT | MS_RDONLY | MS_NOSUID | MS_NODEV, nullptr) != 0) {
+            initFail("remount root read-only");
+        }
+    }
+
+    // 受測程式不需要任何特權：清空 capability bounding set，exec 之後就不會再取得 capability
+    void dropPrivileges() {
+        for (int cap = 0; cap < 64; ++cap) {
+            if (prctl(PR_CAPBSET_DROP, cap, 0, 0, 0) != 0 && errno == EINVAL) break;
+        }
+        prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0);
+    }
+
+    // 結束沙箱內除了 init 以外的所有程序並回收
+    void resetSandbox() {
+        kill(-1, SIGKILL);
+        while (waitpid(-1, nullptr, 0) > 0 || errno == EINTR) {}
+    }
+
+    // 執行一次請求 (執行檔以 binaryFd 傳入)，回傳受測程式的 wait status 與 CPU 時間
+    void runRequest(const InitRequest& request, int binaryFd, int stdinFd, int stdoutFd) {
+        InitReply reply{};
+        reply.type = 'D';
+
+        pid_t child = fork();
+        if (child == 0) {
+            dup2(stdinFd, STDIN_FILENO);
+            dup2(stdoutFd, STDOUT_FILENO);
+            close(INIT_SOCK_FD);
+            if (request.cpu >= 0) {
+                cpu_set_t cpuSet;
+                CPU_ZERO(&cpuSet);
+                CPU_SET(request.cpu, &cpuSet);
+                sched_setaffinity(0, sizeof(cpuSet), &cpuSet);
+            }
+            rlimit cpuLimit{(rlim_t)request.cpuLimitSec, (rlim_t)request.cpuLimitSec + 1};
+            rlimit fileLimit{(rlim_t)request.fileLimitBytes, (rlim_t)request.fileLimitBytes};
+            setrlimit(RLIMIT_CPU, &cpuLimit);
+            setrlimit(RLIMIT_FSIZE, &fileLimit);
+            signal(SIGPIPE, SIG_DFL);
+            dropPrivileges();
+            const char* argv[] = {"main", nullptr};
+            const char* envp[] = {nullptr};
+#ifdef SYS_execveat
+            syscall(SYS_execveat, binaryFd, "", argv, envp, AT_EMPTY_PATH);
+#endif
+            _exit(127);
+        }
+        close(binaryFd);
+        close(stdinFd);
+        close(stdoutFd);
+        if (child < 0) {
+            reply.status = 127 << 8; // 當作無法執行
+            sendMessage(INIT_SOCK_FD, &reply, sizeof(reply));
+            return;
+        }
+
+        // 等待程式結束或判題系統要求強制結束 (逾時、輸出過多)
+        int pidfd = -1;
+#ifdef SYS_pidfd_open
+        pidfd = (int)syscall(SYS_pidfd_open, child, 0);
+#endif
+        int status = 0;
+        rusage usage{};
+        while (true) {
+            pollfd fds[2] = {{INIT_SOCK_FD, POLLIN, 0}, {pidfd, POLLIN, 0}};
+            int ready = poll(fds, pidfd >= 0 ? 2 : 1, pidfd >= 0 ? -1 : 1);
+            if (ready < 0 && errno != EINTR) break;
+            if (ready > 0 && fds[0].revents) {
+                InitRequest message{};
+                if (receiveMessage(INIT_SOCK_FD, &message, sizeof(message)) <= 0) {
+                    resetSandbox();
+                    _exit(0); // 判題系統已結束
+                }
+                if (message.type == 'K') kill(child, SIGKILL);
+            }
+            if (wait4(child, &status, WNOHANG, &usage) == child) break;
+        }
+        if (pidfd >= 0) close(pidfd);
+
+        reply.status = status;
+        reply.cpuUs = (long long)usage.ru_utime.tv_sec * 1000000 + usage.ru_utime.tv_usec
+                    + (long long)usage.ru_stime.tv_sec * 1000000 + usage.ru_stime.tv_usec;
+        resetSandbox(); // 受測程式留下的背景程序在回報前全部清掉
+        sendMessage(INIT_SOCK_FD, &reply, sizeof(reply));
+    }
+#endif
+}
+
+
+// --- SandboxLease ---
+SandboxLease::SandboxLease(SandboxPool* pool, std::unique_ptr<Sandbox> sandbox)
+    : pool(pool), sandbox(std::move(sandbox)) {}
+
+SandboxLease::~SandboxLease() {
+    if (pool && sandbox) pool->release(std::move(sandbox), broken);
+}
+
+SandboxLease::SandboxLease(SandboxLease&& other) noexcept
+    : pool(other.pool), sandbox(std::move(other.sandbox)), broken(other.broken) {
+    other.pool = nullptr;
+}
+
+SandboxLease& SandboxLease::operator=(SandboxLease&& other) noexcept {
+    if (this != &other) {
+        if (pool && sandbox) pool->release(std::move(sandbox), broken);
+        pool = other.pool;
+        sandbox = std::move(other.sandbox);
+        broken = other.broken;
+        other.pool = nullptr;
+    }
+    return *this;
+}
+
+SandboxResult SandboxLease::run(const SandboxRequest& request, const std::string& input,
+                                std::chrono::steady_clock::time_point deadline) {
+    SandboxResult result;
+#ifdef __linux__
+    if (!sandbox) return result;
+
+    int binaryFd = open(request.binaryPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (binaryFd < 0) return result;
+    int stdinPipe[2], stdoutPipe[2];
+    if (pipe2(stdinPipe, O_CLOEXEC) != 0) {
+        close(binaryFd);
+        return result;
+    }
+    if (pipe2(stdoutPipe, O_CLOEXEC) != 0) {
+        close(binaryFd);
+        close(stdinPipe[0]);
+        close(stdinPipe[1]);
+        return result;
+    }
+
+    InitRequest message{};
+    message.type = 'X';
+    message.cpu = request.cpu;
+    message.cpuLimitSec = request.cpuLimitSec;
+    message.fileLimitBytes = request.fileLimitBytes;
+    int childFds[MAX_PASSED_FDS] = {binaryFd, stdinPipe[0], stdoutPipe[1]};
+    bool sent = sendMessage(sandbox->sock, &message, sizeof(message), childFds, MAX_PASSED_FDS);
+    close(binaryFd);
+    close(stdinPipe[0]);
+    close(stdoutPipe[1]);
+    if (!sent) {
+        close(stdinPipe[1]);
+        close(stdoutPipe[0]);
+        broken = true;
+        result.retryable = true; // 請求沒有送達，受測程式還沒開始執行
+        return result;
+    }
+
+    PipeResult io = pumpPipes(stdinPipe[1], stdoutPipe[0], input,
+                              (size_t)WorkspacePool::OUTPUT_LIMIT_BYTES, deadline);
+    InitRequest killMessage{};
+    killMessage.type = 'K';
+    if (io.timedOut || io.overflow || io.ioError) sendMessage(sandbox->sock, &killMessage, sizeof(killMessage));
+
+    // 輸出結束後等待 init 回報結束狀態；超過 deadline 則要求強制結束
+    bool timedOut = io.timedOut;
+    if (!waitReadable(sandbox->sock, deadline)) {
+        timedOut = true;
+        sendMessage(sandbox->sock, &killMessage, sizeof(killMessage));
+    }
+    InitReply reply{};
+    if (!waitReadable(sandbox->sock, std::chrono::steady_clock::now() + std::chrono::seconds(1))
+        || receiveMessage(sandbox->sock, &reply, sizeof(reply)) != (ssize_t)sizeof(reply) || reply.type != 'D') {
+        // init 沒有回應：這個沙箱不能再用。已經逾時的仍以逾時計；受測程式可能已執行了一部分，不能重新執行
+        broken = true;
+        result.ok = timedOut;
+        result.timedOut = timedOut;
+        return result;
+    }
+
+    result.ok = true;
+    result.timedOut = timedOut;
+    result.overflow = io.overflow || io.ioError; // 輸出不完整，同樣以 Runtime Error 計
+    result.status = reply.status;
+    result.cpuMs = reply.cpuUs / 1000.0;
+    result.output = std::move(io.output);
+#else
+    (void)request;
+    (void)input;
+    (void)deadline;
+#endif
+    return result;
+}
+
+
+// --- SandboxPool ---
+SandboxPool& SandboxPool::instance() {
+    static SandboxPool pool;
+    return pool;
+}
+
+SandboxPool::~SandboxPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    warmCv.notify_all();
+    if (warmer.joinable()) warmer.join();
+    for (auto& sandbox : ready) destroy(std::move(sandbox));
+    for (auto& sandbox : retiring) destroy(std::move(sandbox));
+#ifdef __linux__
+    if (!cgroupRoot.empty()) rmdir(cgroupRoot.c_str());
+#endif
+}
+
+// 以 user/mount/pid/net namespace 建立新的沙箱 init：重新執行判題程式本身 (--sandbox-init)，
+// 在 exec 前先寫好 uid/gid 對應並放進 cgroup leaf，再等 init 完成根目錄的設定。
+std::unique_ptr<Sandbox> SandboxPool::spawn(std::string& error) {
+#ifdef __linux__
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv) != 0) {
+        error = std::string("socketpair: ") + strerror(errno);
+        return nullptr;
+    }
+    int sync[2];
+    if (pipe2(sync, O_CLOEXEC) != 0) {
+        error = std::string("pipe: ") + strerror(errno);
+        close(sv[0]);
+        close(sv[1]);
+        return nullptr;
+    }
+
+    // clone 之後子程序只呼叫系統呼叫，所需資料都先準備好
+    const char* argv[] = {selfExe.c_str(), "--sandbox-init", mountDir.c_str(), nullptr};
+    const uid_t uid = getuid();
+    const gid_t gid = getgid();
+
+    long pid = syscall(SYS_clone, CLONE_NEWUSER | CLONE_NEWNS | CLONE_NEWPID | CLONE_NEWNET | SIGCHLD,
+                       nullptr, nullptr, nullptr, nullptr);
+    if (pid == 0) {
+        char go;
+        close(sync[1]);
+        if (read(sync[0], &go, 1) != 1) _exit(1);
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+        if (sv[1] == INIT_SOCK_FD) fcntl(INIT_SOCK_FD, F_SETFD, 0);
+        else dup2(sv[1], INIT_SOCK_FD);
+        execv(argv[0], const_cast<char* const*>(argv));
+        _exit(127);
+    }
+    close(sv[1]);
+    close(sync[0]);
+    if (pid < 0) {
+        error = std::string("clone: ") + strerror(errno);
+        close(sv[0]);
+        close(sync[1]);
+        return nullptr;
+    }
+
+    auto sandbox = std::make_unique<Sandbox>();
+    sandbox->pid = (int)pid;
+    sandbox->sock = sv[0];
+
+    std::string proc = "/proc/" + std::to_string(pid);
+    bool mapped = writeFile(proc + "/setgroups", "deny")
+               && writeFile(proc + "/uid_map", "0 " + std::to_string(uid) + " 1")
+               && writeFile(proc + "/gid_map", "0 " + std::to_string(gid) + " 1");
+    if (!mapped) error = "cannot write uid/gid map (user namespaces unavailable)";
+
+    // 狀態列顯示的上限必須每個沙箱都確實套用，設定失敗的沙箱不能使用
+    if (mapped && !cgroupRoot.empty()) {
+        std::string leaf = cgroupRoot + "/sb-" + std::to_string(nextId++);
+        if (mkdir(leaf.c_str(), 0755) == 0 || errno == EEXIST) {
+            bool limited = (memoryLimitBytes <= 0
+                            || writeFile(leaf + "/memory.max", std::to_string(memoryLimitBytes)))
+                        && (!pidsLimit || writeFile(leaf + "/pids.max", std::to_string(SANDBOX_PIDS_MAX)));
+            if (memoryLimitBytes > 0) writeFile(leaf + "/memory.swap.max", "0"); // 沒有 swap accounting 時不存在
+            if (limited && writeFile(leaf + "/cgroup.procs", std::to_string(pid))) sandbox->cgroup = leaf;
+            else rmdir(leaf.c_str());
+        }
+        if (sandbox->cgroup.empty()) {
+            error = "cannot apply cgroup limits to " + leaf;
+            mapped = false;
+        }
+    }
+
+    if (mapped) {
+        mapped = write(sync[1], "x", 1) == 1;
+    }
+    close(sync[1]);
+
+    InitReply reply{};
+    if (mapped) {
+        if (!waitReadable(sandbox->sock, std::chrono::steady_clock::now() + std::chrono::seconds(5))
+            || receiveMessage(sandbox->sock, &reply, sizeof(reply)) != (ssize_t)sizeof(reply)) {
+            error = "sandbox init did not start";
+        } else if (reply.type != 'R') {
+            error = std::string("sandbox init failed (") + reply.message + ")";
+        }
+    }
+    if (!mapped || reply.type != 'R') {
+        destroy(std::move(sandbox));
+        return nullptr;
+    }
+    return sandbox;
+#else
+    error = "namespaces are only available on Linux";
+    return nullptr;
+#endif
+}
+
+// 結束沙箱 init (整個 pid namespace 隨之結束) 並刪除其 cgroup
+void SandboxPool::destroy(std::unique_ptr<Sandbox> sandbox) {
+#ifdef __linux__
+    if (!sandbox) return;
+    if (sandbox->sock >= 0) close(sandbox->sock);
+    if (sandbox->pid > 0) {
+        kill(sandbox->pid, SIGKILL);
+        waitpid(sandbox->pid, nullptr, 0);
+    }
+    removeCgroup(sandbox->cgroup);
+#else
+    (void)sandbox;
+#endif
+}
+
+void SandboxPool::warmUp(size_t size) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (started) return;
+    started = true;
+    target = std::max<size_t>(size, 1);
+
+    if (envDisabled("JUDGE_SANDBOX")) {
+        disabled = true;
+        status = "disabled (JUDGE_SANDBOX=0)";
+        return;
+    }
+#ifdef __linux__
+    char exe[4096];
+    ssize_t n = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    if (n <= 0) {
+        disabled = true;
+        status = "disabled (cannot locate judge executable)";
+        return;
+    }
+    selfExe.assign(exe, (size_t)n);
+    mountDir = fs::absolute(WorkspacePool::instance().getRoot()).lexically_normal().string() + "/.sandbox-root";
+    std::error_code ec;
+    fs::create_directories(mountDir, ec);
+    cgroupRoot = createCgroupRoot();
+    if (!cgroupRoot.empty()) {
+        const char* memoryMb = std::getenv("JUDGE_MEMORY_MB");
+        long long memoryBytes = (memoryMb ? std::atoll(memoryMb) : 1024) * 1024LL * 1024;
+        memoryLimitBytes = hasController(cgroupRoot, "cgroup.subtree_control", "memory")
+                         ? std::max(0LL, memoryBytes) : 0;
+        pidsLimit = hasController(cgroupRoot, "cgroup.subtree_control", "pids");
+    }
+#endif
+
+    // 先同步建立一個，確認這個環境支援；其餘交給背景執行緒
+    std::string error;
+    auto first = spawn(error);
+    if (!first) {
+        disabled = true;
+        status = "disabled (" + error + ")";
+        return;
+    }
+    ready.push_back(std::move(first));
+    total = 1;
+    status = "user/mount/pid/net namespaces";
+#ifdef __linux__
+    if (memoryLimitBytes > 0 || pidsLimit) {
+        status += " + cgroup v2 (memory ";
+        status += memoryLimitBytes > 0 ? std::to_string(memoryLimitBytes / (1024 * 1024)) + " MB" : "unlimited";
+        status += ", pids ";
+        status += pidsLimit ? std::to_string(SANDBOX_PIDS_MAX) : "unlimited";
+        status += ")";
+    } else {
+        status += cgroupRoot.empty() ? ", no resource limits (cannot create cgroup)"
+                                     : ", no resource limits (memory/pids controllers not delegated to the judge's cgroup)";
+    }
+#endif
+    warmer = std::thread(&SandboxPool::warmLoop, this);
+}
+
+// 背景執行緒：回收故障的沙箱，並把沙箱數量維持在 target
+void SandboxPool::warmLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        warmCv.wait(lock, [this] { return stopping || !retiring.empty() || total < target; });
+        if (stopping) return;
+
+        std::vector<std::unique_ptr<Sandbox>> toDestroy;
+        toDestroy.swap(retiring);
+        bool needMore = total < target;
+        lock.unlock();
+
+        for (auto& sandbox : toDestroy) destroy(std::move(sandbox));
+        std::unique_ptr<Sandbox> fresh;
+        std::string error;
+        if (needMore) {
+            fresh = spawn(error);
+            if (!fresh) std::this_thread::sleep_for(std::chrono::milliseconds(100)); // 暫時性失敗，稍後再試
+        }
+
+        lock.lock();
+        if (fresh) {
+            ready.push_back(std::move(fresh));
+            total++;
+            readyCv.notify_one();
+        }
+    }
+}
+
+bool SandboxPool::enabled() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return started && !disabled;
+}
+
+SandboxLease SandboxPool::acquire() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!started || disabled) return SandboxLease();
+    // 故障的沙箱由背景執行緒補上；一直補不上時 (例如系統資源不足) 不要讓評測卡住，由呼叫端以錯誤計
+    if (!readyCv.wait_for(lock, std::chrono::seconds(10), [this] { return !ready.empty(); })) {
+        return SandboxLease();
+    }
+    auto sandbox = std::move(ready.back());
+    ready.pop_back();
+    return SandboxLease(this, std::move(sandbox));
+}
+
+// 正常的沙箱在 init 回報前已清掉所有程序，直接放回池中；故障的交給背景執行緒回收並補上新的
+void SandboxPool::release(std::unique_ptr<Sandbox> sandbox, bool broken) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (broken) {
+        retiring.push_back(std::move(sandbox));
+        total--;
+        warmCv.notify_one();
+    } else {
+        ready.push_back(std::move(sandbox));
+        readyCv.notify_one();
+    }
+}
+
+std::string SandboxPool::getStatus() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return status;
+}
+
+
+// --- Sandbox init ---
+// 參數：--sandbox-init <mountDir>；與判題系統的 socket 在 fd 3。
+int sandboxInitMain(int argc, char* argv[]) {
+#ifdef __linux__
+    if (argc < 3) return 1;
+    if (!spawnedBySandboxPool()) {
+        fprintf(stderr, "--sandbox-init is internal to the judge and cannot be run directly\n");
+        return 1;
+    }
+    // 只保留 stdin/stdout/stderr 與 socket，其餘從判題系統繼承來的 fd 全部關閉
+    bool closed = false;
+#ifdef SYS_close_range
+    closed = syscall(SYS_close_range, INIT_SOCK_FD + 1, ~0U, 0) == 0;
+#endif
+    if (!closed) {
+        for (int fd = INIT_SOCK_FD + 1; fd < 1024; ++fd) close(fd);
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    setupRoot(argv[2]);
+
+    InitReply ready{};
+    ready.type = 'R';
+    if (!sendMessage(INIT_SOCK_FD, &ready, sizeof(ready))) return 1;
+
+    while (true) {
+        InitRequest request{};
+        int fds[MAX_PASSED_FDS] = {-1, -1, -1};
+        int fdCount = 0;
+        ssize_t n = receiveMessage(INIT_SOCK_FD, &request, sizeof(request), fds, &fdCount);
+        if (n <= 0) return 0; // 判題系統已結束或關閉了沙箱
+        if (request.type != 'X' || fdCount != MAX_PASSED_FDS) {
+            for (int i = 0; i < fdCount; ++i) close(fds[i]);
+            continue; // 例如執行已結束後才送達的 'K'
+        }
+        runRequest(request, fds[0], fds[1], fds[2]);
+    }
+#else
+    (void)argc;
+    (void)argv;
+    return 1;
+#endif
+}
@@ -0,0 +1,383 @@
+// Similarity.cpp
+
+#include "Similarity.hpp"
+#include "ColorPrint.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <unordered_set>
+#include <filesystem>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <ctime>
+#include <cctype>
+
+namespace fs = std::filesystem;
+
+// --- Internal helpers ---
+namespace {
+    struct Token {
+        uint64_t hash;
+        int line;
+    };
+
+    const std::unordered_set<std::string> keywords = {
+        "alignas", "alignof", "auto", "bool", "break", "case", "catch", "char", "class", "const",
+        "constexpr", "const_cast", "continue", "decltype", "default", "delete", "do", "double",
+        "dynamic_cast", "else", "enum", "explicit", "extern", "false", "float", "for", "friend",
+        "goto", "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept", "nullptr",
+        "operator", "private", "protected", "public", "register", "reinterpret_cast", "return",
+        "short", "signed", "sizeof", "static", "static_assert", "static_cast", "struct", "switch",
+        "template", "this", "throw", "true", "try", "typedef", "typename", "union", "unsigned",
+        "using", "virtual", "void", "volatile", "while"
+    };
+
+    // 由長到短嘗試比對的多字元運算子
+    const std::vector<std::string> operators = {
+        "<<=", ">>=", "...", "->*", "<=>",
+        "::", "->", "++", "--", "<<", ">>", "<=", ">=", "==", "!=", "&&", "||",
+        "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", ".*"
+    };
+
+    uint64_t fnv1a(const std::string& data) {
+        uint64_t h = 1469598103934665603ULL;
+        for (unsigned char c : data) {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    bool isIdentStart(char c) { return std::isalpha((unsigned char)c) || c == '_'; }
+    bool isIdentChar(char c)  { return std::isalnum((unsigned char)c) || c == '_'; }
+
+    // 簡易的 C++ lexer：識別字 -> "I"、數字 -> "N"、字串 -> "S"、字元 -> "C"，關鍵字與運算子保留原樣
+    std::vector<Token> tokenize(const std::string& src) {
+        std::vector<Token> tokens;
+        const size_t n = src.size();
+        size_t i = 0;
+        int line = 1;
+        bool lineStart = true;
+
+        auto push = [&](const std::string& text) {
+            tokens.push_back({fnv1a(text), line});
+            lineStart = false;
+        };
+
+        while (i < n) {
+            char c = src[i];
+            if (c == '\n') { line++; i++; lineStart = true; continue; }
+            if (std::isspace((unsigned char)c)) { i++; continue; }
+
+            // 註解
+            if (c == '/' && i + 1 < n && src[i + 1] == '/') {
+                while (i < n && src[i] != '\n') i++;
+                continue;
+            }
+            if (c == '/' && i + 1 < n && src[i + 1] == '*') {
+                i += 2;
+                while (i < n && !(src[i] == '*' && i + 1 < n && src[i + 1] == '/')) {
+                    if (src[i] == '\n') line++;
+                    i++;
+                }
+                i = std::min(n, i + 2);
+                continue;
+            }
+            // 前置處理指令 (含以 '\' 接續的多行)
+            if (c == '#' && lineStart) {
+                while (i < n && src[i] != '\n') {
+                    if (src[i] == '\\' && i + 1 < n && src[i + 1] == '\n') { line++; i++; }
+                    i++;
+                }
+                continue;
+            }
+            // 字串與字元常數
+            if (c == '"' || c == '\'') {
+                char quote = c;
+                i++;
+                while (i < n && src[i] != quote && src[i] != '\n') {
+                    if (src[i] == '\\') i++;
+                    i++;
+                }
+                i++;
+                push(quote == '"' ? "S" : "C");
+                continue;
+            }
+            if (isIdentStart(c)) {
+                size_t start = i;
+                while (i < n && isIdentChar(src[i])) i++;
+                std::string word = src.substr(start, i - start);
+                push(keywords.count(word) ? word : "I");
+                continue;
+            }
+            if (std::isdigit((unsigned char)c) || (c == '.' && i + 1 < n && std::isdigit((unsigned char)src[i + 1]))) {
+                while (i < n && (isIdentChar(src[i]) || src[i] == '.' || src[i] == '\'')) i++;
+                push("N");
+                continue;
+            }
+
+            std::string op(1, c);
+            for (const auto& candidate : operators) {
+                if (src.compare(i, candidate.size(), candidate) == 0) {
+                    op = candidate;
+                    break;
+                }
+            }
+            i += op.size();
+            push(op);
+        }
+        return tokens;
+    }
+
+    std::string readFile(const fs::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream ss;
+        ss << file.rdbuf();
+        return ss.str();
+    }
+
+    // 將同一對文件中相鄰或重疊的相似片段合併
+    std::vector<MatchedRegion> mergeRegions(std::vector<MatchedRegion> regions) {
+        std::sort(regions.begin(), regions.end(), [](const MatchedRegion& a, const MatchedRegion& b) {
+            return a.firstLineA != b.firstLineA ? a.firstLineA < b.firstLineA : a.firstLineB < b.firstLineB;
+        });
+        std::vector<MatchedRegion> merged;
+        for (const auto& r : regions) {
+            if (!merged.empty()) {
+                auto& last = merged.back();
+                bool overlapA = r.firstLineA <= last.lastLineA + 1;
+                bool overlapB = r.firstLineB <= last.lastLineB + 1 && r.lastLineB + 1 >= last.firstLineB;
+                if (overlapA && overlapB) {
+                    last.lastLineA = std::max(last.lastLineA, r.lastLineA);
+                    last.firstLineB = std::min(last.firstLineB, r.firstLineB);
+                    last.lastLineB = std::max(last.lastLineB, r.lastLineB);
+                    continue;
+                }
+            }
+            merged.push_back(r);
+        }
+        return merged;
+    }
+
+    // 不同指紋的數量，不含已被視為樣板的指紋
+    size_t distinctCount(const std::vector<Fingerprint>& fingerprints, const std::unordered_set<uint64_t>& common) {
+        std::unordered_set<uint64_t> seen;
+        for (const auto& fp : fingerprints) {
+            if (!common.count(fp.hash)) seen.insert(fp.hash);
+        }
+        return seen.size();
+    }
+}
+
+// winnowing：對每個長度為 window 的區間取最小的 k-gram hash (相同時取最右邊)，
+// 保證任何長度 >= window + k - 1 個 token 的相同片段至少會有一個共同指紋。
+std::vector<Fingerprint> fingerprintSource(const std::string& source, size_t k, size_t window) {
+    std::vector<Token> tokens = tokenize(source);
+    std::vector<Fingerprint> fingerprints;
+    if (tokens.size() < k || k == 0) return fingerprints;
+
+    std::vector<uint64_t> grams(tokens.size() - k + 1);
+    for (size_t i = 0; i < grams.size(); ++i) {
+        uint64_t h = 0;
+        for (size_t j = 0; j < k; ++j) h = h * 1099511628211ULL + tokens[i + j].hash;
+        grams[i] = h;
+    }
+
+    window = std::max<size_t>(1, std::min(window, grams.size()));
+    size_t lastPicked = grams.size(); // 尚未選過
+    for (size_t start = 0; start + window <= grams.size(); ++start) {
+        size_t best = start;
+        for (size_t i = start; i < start + window; ++i) {
+            if (grams[i] <= grams[best]) best = i;
+        }
+        if (best != lastPicked) {
+            fingerprints.push_back({grams[best], tokens[best].line, tokens[best + k - 1].line});
+            lastPicked = best;
+        }
+    }
+    return fingerprints;
+}
+
+SimilarityIndex::SimilarityIndex(size_t k, size_t window, double threshold)
+    : k(k), window(window), threshold(threshold) {}
+
+size_t SimilarityIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return documentByPath.size();
+}
+
+size_t SimilarityIndex::commonCount() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return commonHashes.size();
+}
+
+// 同一路徑重新加入時，舊版本從倒排索引中移除並釋放指紋；每個 posting list 最多 MAX_POSTINGS 筆，移除成本固定。
+void SimilarityIndex::deactivate(size_t id) {
+    Document& doc = documents[id];
+    doc.active = false;
+    for (const auto& fp : doc.fingerprints) {
+        auto it = postings.find(fp.hash);
+        if (it == postings.end()) continue;
+        auto& list = it->second;
+        list.erase(std::remove(list.begin(), list.end(), id), list.end());
+        if (list.empty()) postings.erase(it);
+    }
+    std::vector<Fingerprint>().swap(doc.fingerprints);
+}
+
+// 查詢新文件與索引中 id >= firstId 的文件的共同指紋 (呼叫者需持有 shared 或 unique lock)。
+// 出現在超過 MAX_POSTINGS 份文件中的指紋 (例如樣板程式碼) 不具鑑別度，移出索引後不再查詢，
+// 因此每個指紋的查詢成本有固定上限，不隨提交數量成長。計算相似度時這些指紋也不列入分母。
+std::vector<SimilarityMatch> SimilarityIndex::findMatches(const std::string& path, const std::vector<Fingerprint>& fingerprints,
+                                                          size_t firstId) const {
+    std::unordered_map<size_t, size_t> shared; // doc id -> 共同指紋數
+    std::unordered_set<uint64_t> distinct;
+    for (const auto& fp : fingerprints) {
+        if (!distinct.insert(fp.hash).second) continue;
+        auto it = postings.find(fp.hash);
+        if (it == postings.end()) continue;
+        for (size_t doc : it->second) {
+            if (doc >= firstId && documents[doc].path != path) shared[doc]++; // 不與自己的舊版本比對
+        }
+    }
+    if (shared.empty()) return {};
+
+    std::unordered_multimap<uint64_t, const Fingerprint*> mine;
+    for (const auto& fp : fingerprints) mine.emplace(fp.hash, &fp);
+    const size_t mineDistinct = distinctCount(fingerprints, commonHashes);
+
+    std::vector<SimilarityMatch> matches;
+    for (const auto& [doc, count] : shared) {
+        const Document& other = documents[doc];
+        size_t denominator = std::min(mineDistinct, distinctCount(other.fingerprints, commonHashes));
+        double score = denominator ? (double)count / denominator : 0;
+        if (score < threshold) continue;
+
+        std::vector<MatchedRegion> regions;
+        for (const auto& fp : other.fingerprints) {
+            auto range = mine.equal_range(fp.hash);
+            for (auto it = range.first; it != range.second; ++it) {
+                regions.push_back({it->second->firstLine, it->second->lastLine, fp.firstLine, fp.lastLine});
+            }
+        }
+        matches.push_back({path, other.path, score, mergeRegions(std::move(regions))});
+    }
+    return matches;
+}
+
+// 比對只需要讀取索引，在 shared lock 下進行，提交之間不會互相阻塞；
+// unique lock 只用來補查比對期間新加入的文件，並把新文件寫入倒排索引。
+std::vector<SimilarityMatch> SimilarityIndex::insert(const std::string& path, std::vector<Fingerprint> fingerprints) {
+    std::vector<SimilarityMatch> matches;
+    size_t checked = 0;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        checked = documents.size();
+        matches = findMatches(path, fingerprints, 0);
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    if (documents.size() > checked) {
+        auto late = findMatches(path, fingerprints, checked);
+        matches.insert(matches.end(), late.begin(), late.end());
+    }
+    std::sort(matches.begin(), matches.end(), [](const SimilarityMatch& a, const SimilarityMatch& b) {
+        return a.score > b.score;
+    });
+
+    auto old = documentByPath.find(path);
+    if (old != documentByPath.end()) deactivate(old->second);
+
+    std::unordered_set<uint64_t> distinct;
+    for (const auto& fp : fingerprints) distinct.insert(fp.hash);
+    size_t id = documents.size();
+    for (uint64_t hash : distinct) {
+        if (commonHashes.count(hash)) continue;
+        auto& list = postings[hash];
+        if (list.size() >= MAX_POSTINGS) {
+            commonHashes.insert(hash);
+            postings.erase(hash);
+            continue;
+        }
+        list.push_back(id);
+    }
+    documents.push_back({path, std::move(fingerprints), true});
+    documentByPath[path] = id;
+    return matches;
+}
+
+std::vector<SimilarityMatch> SimilarityIndex::add(const std::string& path) {
+    std::error_code ec;
+    if (!fs::is_regular_file(path, ec)) return {};
+    return insert(path, fingerprintSource(readFile(path), k, window));
+}
+
+// 指紋計算彼此獨立，分給多個執行緒平行處理；插入索引則依檔名順序逐一進行，
+// 因此每一對相似的提交只會回報一次。
+void SimilarityIndex::build(const std::string& directory, std::vector<SimilarityMatch>* report) {
+    std::vector<fs::path> files;
+    std::error_code ec;
+    for (auto it = fs::recursive_directory_iterator(directory, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        auto ext = it->path().extension();
+        if (it->is_regular_file() && (ext == ".cpp" || ext == ".cc" || ext == ".cxx")) files.push_back(it->path());
+    }
+    std::sort(files.begin(), files.end());
+
+    std::vector<std::vector<Fingerprint>> results(files.size());
+    const size_t threadCount = std::max(1u, std::min<unsigned>(std::thread::hardware_concurrency(), (unsigned)files.size()));
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t] {
+            for (size_t i = t; i < files.size(); i += threadCount) {
+                results[i] = fingerprintSource(readFile(files[i]), k, window);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    for (size_t i = 0; i < files.size(); ++i) {
+        auto matches = insert(files[i].generic_string(), std::move(results[i]));
+        if (report) report->insert(report->end(), matches.begin(), matches.end());
+    }
+}
+
+void printSimilarityReport(const std::vector<SimilarityMatch>& matches, size_t commonFingerprints) {
+    std::cout << cyan("=== Similarity Report ===\n");
+    if (matches.empty()) std::cout << green("No similar submissions found.\n");
+    for (const auto& m : matches) {
+        std::cout << yellow("[") << (int)(m.score * 100) << yellow("%] ") << m.pathA << " ~ " << m.pathB << "\n";
+        for (const auto& r : m.regions) {
+            std::cout << "    lines " << r.firstLineA << "-" << r.lastLineA
+                      << "  ~  lines " << r.firstLineB << "-" << r.lastLineB << "\n";
+        }
+    }
+    if (commonFingerprints) {
+        std::cout << yellow("Note: ") << commonFingerprints << " fingerprints appear in more than "
+                  << SimilarityIndex::MAX_POSTINGS << " submissions and were ignored as boilerplate\n";
+    }
+    std::cout << cyan("=========================\n");
+}
+
+// 提交時的自動檢查結果附加到報告檔，供 admin 事後查閱。
+void appendSimilarityReport(const std::string& reportPath, const std::vector<SimilarityMatch>& matches) {
+    if (matches.empty()) return;
+    std::ofstream out(reportPath, std::ios::app);
+    if (!out) {
+        std::cerr << red("Warning: cannot open similarity report: ") << reportPath << "\n";
+        return;
+    }
+    std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+    for (const auto& m : matches) {
+        out << stamp << "," << m.pathA << "," << m.pathB << "," << (int)(m.score * 100) << "%,";
+        for (size_t i = 0; i < m.regions.size(); ++i) {
+            const auto& r = m.regions[i];
+            out << (i ? ";" : "") << r.firstLineA << "-" << r.lastLineA << ":" << r.firstLineB << "-" << r.lastLineB;
+        }
+        out << "\n";
+    }
+}
@@ -0,0 +1,205 @@
+// Trace.cpp
+
+#include "Trace.hpp"
+#include "Runner.hpp"
+#include "ColorPrint.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <thread>
+
+TraceRecorder::TraceRecorder(std::string tracePath, std::string sourceDir)
+    : tracePath(std::move(tracePath)), sourceDir(std::move(sourceDir)) {}
+
+
+// --- Internal helpers ---
+namespace {
+    long long toEpochMs(std::chrono::system_clock::time_point t) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(t.time_since_epoch()).count();
+    }
+
+    // 取排序後資料的第 p 百分位數 (nearest-rank)
+    double percentile(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) return 0;
+        size_t rank = (size_t)(p / 100.0 * sorted.size() + 0.999999);
+        rank = std::clamp<size_t>(rank, 1, sorted.size());
+        return sorted[rank - 1];
+    }
+
+    // 使用者名稱、題目名稱與路徑都可能含有 , 或 "，這類欄位以雙引號包住，內部的 " 寫成 ""
+    std::string csvField(const std::string& field) {
+        if (field.find_first_of(",\"\r\n") == std::string::npos) return field;
+        std::string quoted = "\"";
+        for (char c : field) quoted += (c == '"') ? std::string("\"\"") : std::string(1, c);
+        return quoted + "\"";
+    }
+
+    // 讀取一筆紀錄並切成欄位；引號內的換行屬於欄位內容，會接著讀下一行。沒有引號的舊格式照常解析。
+    bool readCsvRecord(std::istream& in, std::vector<std::string>& fields) {
+        fields.clear();
+        std::string line;
+        if (!std::getline(in, line)) return false;
+
+        std::string field;
+        bool quoted = false;
+        for (size_t i = 0; ; ++i) {
+            if (i == line.size()) {
+                if (quoted && std::getline(in, line)) {
+                    field += '\n';
+                    i = (size_t)-1;
+                    continue;
+                }
+                break;
+            }
+            char c = line[i];
+            if (quoted) {
+                if (c != '"') field += c;
+                else if (i + 1 < line.size() && line[i + 1] == '"') field += line[++i];
+                else quoted = false;
+            } else if (c == '"') {
+                quoted = true;
+            } else if (c == ',') {
+                fields.push_back(field);
+                field.clear();
+            } else {
+                field += c;
+            }
+        }
+        if (!field.empty() && field.back() == '\r') field.pop_back();
+        fields.push_back(field);
+        return true;
+    }
+}
+
+// 程式碼快照以 <時間>-<序號>-<檔名> 命名，避免使用者之後修改檔案影響重播結果。
+// 若程式碼檔案不存在 (例如打錯檔名)，則保留原路徑，重播時同樣會得到 Compile Error。
+void TraceRecorder::record(std::chrono::system_clock::time_point arrival,
+                           const std::string& username,
+                           const std::string& problemTitle,
+                           const std::string& codePath,
+                           Verdict verdict) {
+    std::lock_guard<std::mutex> lock(mutex);
+    long long arrivalMs = toEpochMs(arrival);
+
+    std::string sourcePath = codePath;
+    std::error_code ec;
+    if (fs::exists(codePath, ec)) {
+        fs::create_directories(sourceDir, ec);
+        fs::path snapshot = fs::path(sourceDir) /
+            (std::to_string(arrivalMs) + "-" + std::to_string(sequence++) + "-" + fs::path(codePath).filename().string());
+        if (fs::copy_file(codePath, snapshot, fs::copy_options::overwrite_existing, ec)) {
+            sourcePath = snapshot.generic_string();
+        }
+    }
+
+    std::ofstream out(tracePath, std::ios::app);
+    if (!out) {
+        std::cerr << red("Warning: cannot open trace file: ") << tracePath << "\n";
+        return;
+    }
+    out << arrivalMs << "," << csvField(username) << "," << csvField(problemTitle) << ","
+        << csvField(sourcePath) << "," << verdictName(verdict) << "\n";
+}
+
+std::vector<TraceEntry> loadTrace(const std::string& tracePath) {
+    std::vector<TraceEntry> trace;
+    std::ifstream file(tracePath);
+    if (!file) {
+        std::cerr << red("Error: Cannot open trace file: ") << tracePath << "\n";
+        return trace;
+    }
+
+    std::vector<std::string> fields;
+    while (readCsvRecord(file, fields)) {
+        if (fields.size() != 5) continue; // 空行或格式錯誤的行直接略過
+        TraceEntry entry;
+        entry.username = fields[1];
+        entry.problemTitle = fields[2];
+        entry.sourcePath = fields[3];
+        try {
+            entry.arrivalMs = std::stoll(fields[0]);
+        } catch (...) {
+            continue;
+        }
+        if (!parseVerdict(fields[4], entry.verdict)) continue;
+        trace.push_back(entry);
+    }
+
+    std::sort(trace.begin(), trace.end(), [](const TraceEntry& a, const TraceEntry& b) {
+        return a.arrivalMs < b.arrivalMs;
+    });
+    return trace;
+}
+
+// 延遲 (latency) 以「排定的到達時間」到「評測完成」計算，因此包含排隊等待的時間。
+// 評測交給 JudgePipeline，讓後一份提交的編譯與前一份提交的執行重疊。
+ReplayReport replayTrace(ProblemSystem& problemSystem, const std::vector<TraceEntry>& trace, double speed) {
+    using Clock = std::chrono::steady_clock;
+    ReplayReport report;
+    report.total = trace.size();
+    if (trace.empty()) return report;
+
+    std::vector<Clock::time_point> scheduled(trace.size());
+    std::vector<double> latencies;
+    std::mutex reportMutex;
+    const long long firstArrival = trace.front().arrivalMs;
+    const auto start = Clock::now();
+
+    {
+        JudgePipeline pipeline([&](size_t i, Verdict verdict, size_t) {
+            double latency = std::chrono::duration<double, std::milli>(Clock::now() - scheduled[i]).count();
+            std::lock_guard<std::mutex> lock(reportMutex);
+            latencies.push_back(latency);
+            report.judged++;
+            if (verdict == trace[i].verdict) {
+                report.agreed++;
+            } else {
+                report.mismatches.push_back(trace[i].username + " / " + trace[i].problemTitle + " (" + trace[i].sourcePath + "): "
+                                            + verdictName(trace[i].verdict) + " -> " + verdictName(verdict));
+            }
+        });
+
+        for (size_t i = 0; i < trace.size(); ++i) {
+            const auto& entry = trace[i];
+            scheduled[i] = start;
+            if (speed > 0) {
+                scheduled[i] += std::chrono::microseconds((long long)((entry.arrivalMs - firstArrival) * 1000 / speed));
+                std::this_thread::sleep_until(scheduled[i]);
+            }
+
+            auto problem = problemSystem.findProblem(entry.problemTitle);
+            auto testcases = problem ? problemSystem.testcasePrepare(*problem) : nullptr;
+            if (!testcases) {
+                std::lock_guard<std::mutex> lock(reportMutex);
+                report.skipped++;
+                continue;
+            }
+            pipeline.submit({i, entry.sourcePath, std::move(testcases), problem->getTimeLimitMs()});
+        }
+        pipeline.finish();
+    }
+
+    report.wallSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::sort(latencies.begin(), latencies.end());
+    report.p50Ms = percentile(latencies, 50);
+    report.p90Ms = percentile(latencies, 90);
+    report.p99Ms = percentile(latencies, 99);
+    report.maxMs = latencies.empty() ? 0 : latencies.back();
+    return report;
+}
+
+void printReplayReport(const ReplayReport& report) {
+    std::cout << cyan("=== Replay Report ===\n");
+    std::cout << "Submissions : " << report.total << " (judged " << report.judged
+              << ", skipped " << report.skipped << ")\n";
+    std::cout << "Wall time   : " << report.wallSeconds << " s\n";
+    std::cout << "Throughput  : " << (report.wallSeconds > 0 ? report.judged / report.wallSeconds : 0) << " submissions/s\n";
+    std::cout << "Latency (ms): p50 " << report.p50Ms << ", p90 " << report.p90Ms
+              << ", p99 " << report.p99Ms << ", max " << report.maxMs << "\n";
+    std::cout << "Agreement   : " << report.agreed << "/" << report.judged << "\n";
+    for (const auto& m : report.mismatches) {
+        std::cout << red("Mismatch: ") << m << "\n";
+    }
+    std::cout << cyan("=====================\n");
+}
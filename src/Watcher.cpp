@@ -0,0 +1,174 @@
+// Watcher.cpp
+
+#include "Watcher.hpp"
+
+#include <filesystem>
+#include <chrono>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <climits>
+#endif
+
+namespace fs = std::filesystem;
+
+// --- Internal helpers ---
+namespace {
+    constexpr int DEBOUNCE_MS = 100;   // 最後一次變動後等待多久才通知
+    constexpr int POLL_MS     = 200;   // 檢查 stopping 的間隔
+
+    // 轉成一致的路徑表示，讓 "data/problem/a/" 與 "data/problem/a" 視為同一個資料夾
+    std::string normalize(const std::string& path) {
+        fs::path p = fs::path(path).lexically_normal();
+        if (!p.has_filename()) p = p.parent_path();
+        return p.generic_string();
+    }
+}
+
+CatalogWatcher::CatalogWatcher(std::string catalogPath, ListDirs listDirs,
+                               OnCatalogChange onCatalogChange, OnProblemChange onProblemChange)
+    : catalogPath(std::move(catalogPath)), listDirs(std::move(listDirs)),
+      onCatalogChange(std::move(onCatalogChange)), onProblemChange(std::move(onProblemChange)) {
+#ifdef __linux__
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd >= 0) {
+        fs::path parent = fs::path(this->catalogPath).parent_path();
+        int wd = inotify_add_watch(inotifyFd, parent.empty() ? "." : parent.c_str(),
+                                   IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+        if (wd >= 0) watchedDirs[wd] = "";  // 空字串代表題目清單所在的資料夾
+        addWatches();
+    }
+#else
+    pollChanges(); // 記錄初始狀態
+    catalogDirty = false;
+    dirtyProblems.clear();
+#endif
+    thread = std::thread(&CatalogWatcher::loop, this);
+}
+
+CatalogWatcher::~CatalogWatcher() {
+    stopping = true;
+    if (thread.joinable()) thread.join();
+#ifdef __linux__
+    if (inotifyFd >= 0) close(inotifyFd);
+#endif
+}
+
+// 累積變動，直到安靜 DEBOUNCE_MS 之後才一次通知。題目清單變動後可能新增了題目資料夾，需重新加入監看。
+void CatalogWatcher::loop() {
+    using Clock = std::chrono::steady_clock;
+    auto lastChange = Clock::now();
+
+    while (!stopping) {
+#ifdef __linux__
+        if (inotifyFd < 0) return;
+        bool changed = readEvents(POLL_MS);
+#else
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        bool changed = pollChanges();
+#endif
+        if (changed) {
+            lastChange = Clock::now();
+            continue;
+        }
+        if (!catalogDirty && dirtyProblems.empty()) continue;
+        if (Clock::now() - lastChange < std::chrono::milliseconds(DEBOUNCE_MS)) continue;
+
+        bool catalog = catalogDirty;
+        std::set<std::string> problems;
+        problems.swap(dirtyProblems);
+        catalogDirty = false;
+
+        if (catalog) onCatalogChange();
+        for (const auto& basePath : problems) onProblemChange(basePath);
+#ifdef __linux__
+        if (catalog || !problems.empty()) addWatches();
+#endif
+    }
+}
+
+#ifdef __linux__
+// 監看每個題目資料夾本身 (測資資料夾被整個替換時) 與其 testcases 資料夾 (個別測資變動時)。
+// 對同一路徑重複 inotify_add_watch 會得到相同的 watch descriptor，因此可以安全地重複呼叫。
+void CatalogWatcher::addWatches() {
+    const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE;
+    for (const auto& dir : listDirs()) {
+        std::string basePath = normalize(dir);
+        for (const fs::path& p : {fs::path(basePath), fs::path(basePath) / "testcases"}) {
+            int wd = inotify_add_watch(inotifyFd, p.c_str(), mask);
+            if (wd >= 0) watchedDirs[wd] = basePath;
+        }
+    }
+}
+
+bool CatalogWatcher::readEvents(int timeoutMs) {
+    pollfd pfd{inotifyFd, POLLIN, 0};
+    if (poll(&pfd, 1, timeoutMs) <= 0) return false;
+
+    alignas(inotify_event) char buffer[16 * (sizeof(inotify_event) + NAME_MAX + 1)];
+    bool changed = false;
+    while (true) {
+        ssize_t len = read(inotifyFd, buffer, sizeof(buffer));
+        if (len <= 0) break;
+        for (char* ptr = buffer; ptr < buffer + len; ) {
+            auto* event = reinterpret_cast<inotify_event*>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_IGNORED) {
+                watchedDirs.erase(event->wd); // 資料夾被刪除或移走
+                continue;
+            }
+            auto it = watchedDirs.find(event->wd);
+            if (it == watchedDirs.end()) continue;
+
+            if (it->second.empty()) {
+                std::string name = event->len ? event->name : "";
+                if (name != fs::path(catalogPath).filename().string()) continue;
+                catalogDirty = true;
+            } else {
+                dirtyProblems.insert(it->second);
+            }
+            changed = true;
+        }
+    }
+    return changed;
+}
+#else
+std::string CatalogWatcher::signatureOf(const std::string& path) const {
+    std::error_code ec;
+    std::string sig;
+    auto append = [&](const fs::path& p) {
+        auto time = fs::last_write_time(p, ec).time_since_epoch().count();
+        auto size = fs::is_regular_file(p, ec) ? fs::file_size(p, ec) : 0;
+        sig += p.filename().string() + ":" + std::to_string(time) + ":" + std::to_string(size) + ";";
+    };
+    if (!fs::is_directory(path, ec)) {
+        append(path);
+        return sig;
+    }
+    for (auto& entry : fs::directory_iterator(fs::path(path) / "testcases", ec)) append(entry.path());
+    return sig;
+}
+
+bool CatalogWatcher::pollChanges() {
+    bool changed = false;
+    std::string sig = signatureOf(catalogPath);
+    if (signatures[catalogPath] != sig) {
+        signatures[catalogPath] = sig;
+        catalogDirty = true;
+        changed = true;
+    }
+    for (const auto& dir : listDirs()) {
+        std::string basePath = normalize(dir);
+        sig = signatureOf(basePath);
+        if (signatures[basePath] != sig) {
+            signatures[basePath] = sig;
+            dirtyProblems.insert(basePath);
+            changed = true;
+        }
+    }
+    return changed;
+}
+#endif
@@ -0,0 +1,139 @@
+// Workspace.cpp
+
+#include "Workspace.hpp"
+
+#include <fstream>
+#include <string>
+
+#ifdef _WIN32
+#include <process.h>
+#define BINARY_EXT ".exe"
+#define getProcessId _getpid
+#else
+#include <unistd.h>
+#include <sys/statvfs.h>
+#define BINARY_EXT ""
+#define getProcessId getpid
+#endif
+
+// --- Internal helpers ---
+namespace {
+#ifndef _WIN32
+    constexpr unsigned long long MIN_SHM_FREE_BYTES = 256ULL * 1024 * 1024; // 至少要放得下數個執行檔與輸出
+
+    // /dev/shm 必須可寫、可執行 (Docker 等環境預設以 noexec 掛載)，且剩餘空間足夠
+    bool usableShm(const char* path) {
+        std::error_code ec;
+        if (!fs::is_directory(path, ec) || access(path, W_OK) != 0) return false;
+        struct statvfs st;
+        if (statvfs(path, &st) != 0) return false;
+        if (st.f_flag & ST_NOEXEC) return false;
+        return (unsigned long long)st.f_bavail * st.f_frsize >= MIN_SHM_FREE_BYTES;
+    }
+#endif
+
+    // 選擇工作區的根目錄：優先使用記憶體檔案系統，無法使用時退回磁碟
+    fs::path chooseBase() {
+#ifndef _WIN32
+        if (usableShm("/dev/shm")) return "/dev/shm";
+#endif
+        return "build/workspace";
+    }
+
+    // 清除先前異常結束 (沒有執行解構) 的程序留下的工作區
+    void removeStaleWorkspaces(const fs::path& base) {
+#ifndef _WIN32
+        std::error_code ec;
+        for (auto& entry : fs::directory_iterator(base, ec)) {
+            std::string name = entry.path().filename().string();
+            if (name.rfind("judge-", 0) != 0) continue;
+            std::string pid = name.substr(6);
+            if (pid.empty() || pid.find_first_not_of("0123456789") != std::string::npos) continue;
+            if (fs::exists("/proc/" + pid, ec)) continue; // 該程序仍在執行
+            fs::remove_all(entry.path(), ec);
+        }
+#else
+        (void)base;
+#endif
+    }
+}
+
+
+// --- WorkspaceLease ---
+WorkspaceLease::WorkspaceLease(WorkspacePool* pool, size_t id, RunTarget target)
+    : pool(pool), id(id), runTarget(std::move(target)) {}
+
+WorkspaceLease::~WorkspaceLease() {
+    release();
+}
+
+void WorkspaceLease::release() {
+    if (pool) pool->release(id);
+    pool = nullptr;
+}
+
+WorkspaceLease::WorkspaceLease(WorkspaceLease&& other) noexcept
+    : pool(other.pool), id(other.id), runTarget(std::move(other.runTarget)) {
+    other.pool = nullptr;
+}
+
+WorkspaceLease& WorkspaceLease::operator=(WorkspaceLease&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool = other.pool;
+        id = other.id;
+        runTarget = std::move(other.runTarget);
+        other.pool = nullptr;
+    }
+    return *this;
+}
+
+
+// --- WorkspacePool ---
+WorkspacePool::WorkspacePool() {
+    fs::path base = chooseBase();
+    removeStaleWorkspaces(base);
+    root = base / ("judge-" + std::to_string(getProcessId()));
+    fs::create_directories(root);
+}
+
+WorkspacePool::~WorkspacePool() {
+    std::error_code ec;
+    fs::remove_all(root, ec);
+}
+
+WorkspacePool& WorkspacePool::instance() {
+    static WorkspacePool pool;
+    return pool;
+}
+
+// 優先重複使用空閒的工作區，沒有時才建立新的。
+WorkspaceLease WorkspacePool::acquire() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (freeList.empty()) {
+        size_t id = workspaces.size();
+        fs::path dir = root / ("ws-" + std::to_string(id));
+        fs::create_directories(dir);
+        RunTarget target;
+        target.binaryPath = (dir / ("user_program" BINARY_EXT)).string();
+#ifdef _WIN32
+        target.inputPath = (dir / "input.txt").string();
+        target.outputPath = (dir / "user_output.txt").string();
+#endif
+        workspaces.push_back(target);
+        freeList.push_back(id);
+    }
+    size_t id = freeList.back();
+    freeList.pop_back();
+    return WorkspaceLease(this, id, workspaces[id]);
+}
+
+// 歸還工作區。執行檔留待下次編譯直接覆蓋；Windows 另外清空輸入與輸出檔 (保留檔案本身)。
+void WorkspacePool::release(size_t id) {
+    std::lock_guard<std::mutex> lock(mutex);
+#ifdef _WIN32
+    std::ofstream(workspaces[id].inputPath, std::ios::trunc);
+    std::ofstream(workspaces[id].outputPath, std::ios::trunc);
+#endif
+    freeList.push_back(id);
+}
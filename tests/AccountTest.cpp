@@ -0,0 +1,105 @@
+// AccountTest.cpp
+
+#include "Account.hpp"
+#include "Check.hpp"
+
+#include <fstream>
+#include <set>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+// init 與 search 是 protected，測試透過子類別使用
+class TestAccounts : public AccountSystem {
+public:
+    using AccountSystem::init;
+    using AccountSystem::search;
+};
+
+namespace {
+    bool isHexToken(const std::string& token) {
+        return token.size() == 32 && std::all_of(token.begin(), token.end(), [](char c) {
+            return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+        });
+    }
+
+    void testSessions(TestAccounts& accounts) {
+        CHECK(accounts.authenticate("alice", "wrong").empty());
+        CHECK(accounts.authenticate("nobody", "pw").empty());
+
+        std::string first = accounts.authenticate("alice", "secret");
+        std::string second = accounts.authenticate("alice", "secret");
+        CHECK(isHexToken(first));
+        CHECK(isHexToken(second));
+        CHECK(first != second);
+        CHECK_EQ(accounts.sessionUser(first), std::string("alice"));
+
+        accounts.logout(first);
+        CHECK(accounts.sessionUser(first).empty());
+        CHECK_EQ(accounts.sessionUser(second), std::string("alice")); // 登出只影響該 session
+        CHECK(accounts.sessionUser("").empty());
+    }
+
+    void testRegister(TestAccounts& accounts) {
+        CHECK(accounts.registerUser("bob", "pw"));
+        CHECK(!accounts.registerUser("bob", "other"));   // 已存在
+        CHECK(!accounts.registerUser("a,b", "pw"));      // 會破壞 user.csv 的欄位
+        CHECK(!accounts.registerUser("", "pw"));
+        CHECK(!accounts.authenticate("bob", "pw").empty());
+        CHECK(!accounts.search("a,b"));
+    }
+
+    // 多個執行緒同時註冊同一個名稱，只有一個會成功；同時登入產生的 token 彼此不重複
+    void testConcurrent(TestAccounts& accounts) {
+        constexpr int THREADS = 8, ROUNDS = 200;
+        std::vector<int> wins(THREADS, 0);
+        std::vector<std::vector<std::string>> tokens(THREADS);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&, t] {
+                for (int i = 0; i < ROUNDS; ++i) {
+                    if (accounts.registerUser("user" + std::to_string(i), "pw")) wins[t]++;
+                    tokens[t].push_back(accounts.authenticate("alice", "secret"));
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        int total = 0;
+        for (int w : wins) total += w;
+        CHECK_EQ(total, ROUNDS);
+
+        std::set<std::string> unique;
+        for (const auto& list : tokens) {
+            for (const auto& token : list) {
+                CHECK_EQ(accounts.sessionUser(token), std::string("alice"));
+                unique.insert(token);
+            }
+        }
+        CHECK_EQ(unique.size(), (size_t)THREADS * ROUNDS);
+    }
+}
+
+int main() {
+    TempDir dir;
+    const std::string userData = dir.file("user.csv");
+    std::ofstream(userData) << "alice,secret\n";
+
+    {
+        TestAccounts accounts;
+        accounts.init(userData);
+        CHECK(accounts.search("alice").has_value());
+        testSessions(accounts);
+        testRegister(accounts);
+        testConcurrent(accounts);
+    } // 解構時寫回檔案
+
+    // 背景寫回的檔案可以重新載入，且不含被拒絕的名稱
+    TestAccounts reloaded;
+    reloaded.init(userData);
+    CHECK(reloaded.search("bob").has_value());
+    CHECK(reloaded.search("user0").has_value());
+    CHECK(!reloaded.search("a,b").has_value());
+    CHECK(!reloaded.authenticate("alice", "secret").empty());
+    return checkResult("AccountTest");
+}
@@ -0,0 +1,85 @@
+// AsyncIoTest.cpp
+
+#include "AsyncIo.hpp"
+#include "Check.hpp"
+
+#include <fstream>
+#include <csignal>
+#include <unistd.h>
+#include <sys/wait.h>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    void testReadFiles(const TempDir& dir) {
+        std::string big(3 * 1024 * 1024 + 17, 'x');
+        std::ofstream(dir.file("a.txt")) << "alpha\n";
+        std::ofstream(dir.file("big.txt")) << big;
+        std::ofstream(dir.file("empty.txt"));
+
+        auto contents = readFiles({dir.file("a.txt"), dir.file("missing.txt"), dir.file("big.txt"), dir.file("empty.txt")});
+        CHECK_EQ(contents.size(), (size_t)4);
+        if (contents.size() != 4) return;
+        CHECK_EQ(contents[0], std::string("alpha\n"));
+        CHECK(contents[1].empty());
+        CHECK(contents[2] == big);
+        CHECK(contents[3].empty());
+    }
+
+    // 以 pipe 接上子程序的 stdin/stdout 後交給 pumpPipes，回傳結果並回收子程序
+    PipeResult pump(const std::vector<const char*>& command, const std::string& input, size_t limit,
+                    Clock::duration timeout) {
+        int in[2], out[2];
+        if (pipe(in) != 0 || pipe(out) != 0) return {};
+        pid_t pid = fork();
+        if (pid == 0) {
+            dup2(in[0], STDIN_FILENO);
+            dup2(out[1], STDOUT_FILENO);
+            close(in[0]); close(in[1]); close(out[0]); close(out[1]);
+            std::vector<char*> argv;
+            for (const char* arg : command) argv.push_back(const_cast<char*>(arg));
+            argv.push_back(nullptr);
+            execvp(argv[0], argv.data());
+            _exit(127);
+        }
+        close(in[0]);
+        close(out[1]);
+        PipeResult result = pumpPipes(in[1], out[0], input, limit, Clock::now() + timeout);
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+        return result;
+    }
+
+    void testPumpPipes() {
+        // 輸入與輸出都遠大於 pipe 緩衝區，必須同時寫入與讀取才不會卡住
+        std::string input;
+        for (int i = 0; input.size() < 8 * 1024 * 1024; ++i) input += std::to_string(i) + "\n";
+        PipeResult echoed = pump({"cat"}, input, input.size() + 1, std::chrono::seconds(20));
+        CHECK(!echoed.timedOut);
+        CHECK(!echoed.overflow);
+        CHECK(!echoed.ioError);
+        CHECK(echoed.output == input);
+
+        PipeResult limited = pump({"cat"}, input, 4096, std::chrono::seconds(20));
+        CHECK(limited.overflow);
+
+        // 受測程式沒有讀取 stdin 就結束：評測端收到 EPIPE，不算評測端的錯誤
+        PipeResult ignored = pump({"true"}, input, 4096, std::chrono::seconds(20));
+        CHECK(!ignored.timedOut);
+        CHECK(!ignored.ioError);
+        CHECK(ignored.output.empty());
+
+        PipeResult slow = pump({"sleep", "5"}, "", 4096, std::chrono::milliseconds(200));
+        CHECK(slow.timedOut);
+    }
+}
+
+int main() {
+    signal(SIGPIPE, SIG_IGN); // 與 runCode 相同，寫入已關閉的 pipe 改為收到 EPIPE
+
+    TempDir dir;
+    std::cout << "io_uring: " << (asyncIoAvailable() ? "available" : "unavailable, using poll()") << "\n";
+    testReadFiles(dir);
+    testPumpPipes();
+    return checkResult("AsyncIoTest");
+}
@@ -0,0 +1,64 @@
+// Check.hpp
+
+#ifndef CHECK_HPP
+#define CHECK_HPP
+
+#include <iostream>
+#include <string>
+#include <filesystem>
+#include <random>
+
+// 測試用的最小斷言：失敗時印出位置並繼續執行，main 最後以 checkResult() 的回傳值結束。
+inline int& checkFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(cond)                                                                        \
+    do {                                                                                   \
+        if (!(cond)) {                                                                     \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #cond "\n";     \
+            ++checkFailures();                                                             \
+        }                                                                                  \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                         \
+    do {                                                                                   \
+        auto&& checkActual_ = (actual);                                                    \
+        auto&& checkExpected_ = (expected);                                                \
+        if (!(checkActual_ == checkExpected_)) {                                           \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQ failed: " #actual      \
+                      << " == " << checkActual_ << ", expected " << checkExpected_ << "\n"; \
+            ++checkFailures();                                                             \
+        }                                                                                  \
+    } while (0)
+
+inline int checkResult(const char* name) {
+    if (checkFailures()) {
+        std::cerr << name << ": " << checkFailures() << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << name << ": OK\n";
+    return 0;
+}
+
+// 每個測試使用自己的暫存資料夾，結束時刪除
+class TempDir {
+public:
+    TempDir() {
+        path = std::filesystem::temp_directory_path() / ("judge-test-" + std::to_string(std::random_device{}()));
+        std::filesystem::create_directories(path);
+    }
+    ~TempDir() {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+    }
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    std::string file(const std::string& name) const { return (path / name).string(); }
+
+    std::filesystem::path path;
+};
+
+#endif // CHECK_HPP
@@ -0,0 +1,65 @@
+// CompilerTest.cpp
+
+#include "Compiler.hpp"
+#include "Check.hpp"
+
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const std::string program = "#include <iostream>\nint main() { std::cout << 42; }\n";
+
+    size_t cachedBinaries() {
+        size_t count = 0;
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator("build/cache", ec)) {
+            if (entry.is_regular_file()) ++count;
+        }
+        return count;
+    }
+
+    // 檔名中的引號與 ; 只是檔名的一部分，不會被 shell 執行
+    void testHostileNames(CompileService& compiler) {
+        const std::string quoted = "a';touch pwned;'.cpp";
+        std::ofstream(quoted) << program;
+        CHECK(compiler.compile(quoted, "quoted.bin"));
+        CHECK(fs::exists("quoted.bin"));
+        CHECK(!fs::exists("pwned"));
+
+        // 以 - 開頭的檔名不會被 g++ 當成參數
+        const std::string dashed = "-o.cpp";
+        std::ofstream(dashed) << "int main() { return 0; }\n";
+        CHECK(compiler.compile(dashed, "dashed.bin"));
+        CHECK(fs::exists("dashed.bin"));
+        CHECK(fs::exists(dashed));
+    }
+
+    // 相同原始碼只編譯一次，之後從快取複製；編譯失敗不會放入快取
+    void testCache(CompileService& compiler) {
+        const size_t before = cachedBinaries();
+        const std::string source = "int main() { return 7; }\n";
+        std::ofstream("first.cpp") << source;
+        std::ofstream("second.cpp") << source; // 內容相同、檔名不同
+        CHECK(compiler.compile("first.cpp", "first.bin"));
+        CHECK(compiler.compile("second.cpp", "second.bin"));
+        CHECK_EQ(cachedBinaries(), before + 1);
+        CHECK_EQ(fs::file_size("first.bin"), fs::file_size("second.bin"));
+
+        std::ofstream("broken.cpp") << "int main() { return }\n";
+        CHECK(!compiler.compile("broken.cpp", "broken.bin"));
+        CHECK(!compiler.compile("missing.cpp", "missing.bin"));
+        CHECK_EQ(cachedBinaries(), before + 1);
+    }
+}
+
+int main() {
+    // build/pch 與 build/cache 都是相對路徑，在暫存資料夾中執行以免動到專案的快取
+    TempDir dir;
+    fs::current_path(dir.path);
+
+    CompileService& compiler = CompileService::instance();
+    testHostileNames(compiler);
+    testCache(compiler);
+    return checkResult("CompilerTest");
+}
@@ -0,0 +1,189 @@
+// ContestTest.cpp
+
+#include "Contest.hpp"
+#include "Check.hpp"
+
+#include <fstream>
+
+namespace {
+    constexpr long long START = 1000000; // 以固定的時間建立已經結束的比賽
+    constexpr long long MINUTE = 60;
+
+    std::vector<std::string> cellsOf(const std::vector<ScoreRow>& rows) {
+        return rows.empty() ? std::vector<std::string>() : rows[0].cells;
+    }
+
+    std::string leader(const Contest& contest, bool live) {
+        auto rows = contest.scoreboard(1, live);
+        return rows.empty() ? "" : rows[0].username;
+    }
+
+    void testIcpc() {
+        Standings standings(ContestMode::ICPC, 2);
+        standings.apply("alice", 0, Verdict::WrongAnswer, 0, 5);
+        standings.apply("alice", 0, Verdict::CompileError, 0, 8);  // 不計罰時
+        standings.apply("alice", 0, Verdict::Accepted, 0, 10);     // 10 + 20
+        standings.apply("alice", 0, Verdict::WrongAnswer, 0, 12);  // AC 之後不影響成績
+        standings.apply("bob", 0, Verdict::Accepted, 0, 30);
+        standings.apply("carol", 1, Verdict::TimeLimitExceeded, 0, 3);
+
+        CHECK_EQ(standings.size(), (size_t)3);
+        CHECK_EQ(standings.rankOf("alice"), 1);
+        CHECK_EQ(standings.rankOf("bob"), 1);     // 同解題數與罰時，名次相同
+        CHECK_EQ(standings.rankOf("carol"), 3);
+        CHECK_EQ(standings.rankOf("dave"), -1);
+
+        auto alice = standings.row("alice");
+        CHECK_EQ(alice.size(), (size_t)1);
+        if (alice.size() == 1) {
+            CHECK_EQ(alice[0].score, 1LL);
+            CHECK_EQ(alice[0].penalty, 30LL);
+            CHECK(alice[0].cells == std::vector<std::string>({"+1 (10)", ""}));
+        }
+        CHECK(cellsOf(standings.row("bob")) == std::vector<std::string>({"+ (30)", ""}));
+        CHECK(cellsOf(standings.row("carol")) == std::vector<std::string>({"", "-1"}));
+
+        // 多解一題的人排在前面，之後依罰時排序
+        standings.apply("carol", 1, Verdict::Accepted, 0, 40);
+        standings.apply("carol", 0, Verdict::Accepted, 0, 50);
+        auto top = standings.top(2);
+        CHECK_EQ(top.size(), (size_t)2);
+        if (top.size() == 2) {
+            CHECK_EQ(top[0].username, std::string("carol"));
+            CHECK_EQ(top[0].penalty, 110LL);
+            CHECK_EQ(top[1].rank, 2);
+        }
+        CHECK(standings.row("dave").empty());
+    }
+
+    void testIoi() {
+        Standings standings(ContestMode::IOI, 2);
+        standings.apply("alice", 0, Verdict::WrongAnswer, 40, 1);
+        standings.apply("alice", 0, Verdict::WrongAnswer, 70, 2);
+        standings.apply("alice", 0, Verdict::WrongAnswer, 30, 3);  // 每題取最高分
+        standings.apply("bob", 0, Verdict::Accepted, 100, 4);
+        standings.apply("bob", 1, Verdict::CompileError, 0, 5);
+
+        auto alice = standings.row("alice");
+        CHECK(!alice.empty());
+        if (!alice.empty()) {
+            CHECK_EQ(alice[0].score, 70LL);
+            CHECK_EQ(alice[0].penalty, 0LL);
+            CHECK(alice[0].cells == std::vector<std::string>({"70", ""}));
+        }
+        CHECK(cellsOf(standings.row("bob")) == std::vector<std::string>({"100", "0"}));
+        CHECK_EQ(standings.rankOf("bob"), 1);
+        CHECK_EQ(standings.rankOf("alice"), 2);
+
+        standings.apply("alice", 1, Verdict::WrongAnswer, 40, 6);
+        CHECK_EQ(standings.rankOf("alice"), 1);
+        CHECK_EQ(standings.rankOf("bob"), 2);
+    }
+
+    void testPending() {
+        Standings standings(ContestMode::ICPC, 2);
+        standings.apply("alice", 0, Verdict::Accepted, 0, 10);
+        standings.markPending("alice", 0);  // 已解出的題目不標示待定
+        standings.markPending("alice", 1);
+        standings.markPending("alice", 1);
+        standings.markPending("bob", 1);
+        standings.markPending("bob", 5);    // 不存在的題目略過
+        CHECK(cellsOf(standings.row("alice")) == std::vector<std::string>({"+ (10)", "?2"}));
+        CHECK(cellsOf(standings.row("bob")) == std::vector<std::string>({"", "?1"}));
+        CHECK_EQ(standings.rankOf("bob"), 2);
+    }
+
+    ContestConfig makeConfig() {
+        ContestConfig config;
+        config.name = "practice";
+        config.mode = ContestMode::ICPC;
+        config.start = START;
+        config.end = START + 300 * MINUTE;
+        config.freezeMinutes = 60;
+        config.problems = {"A", "B"};
+        return config;
+    }
+
+    void testContest(const TempDir& dir) {
+        const std::string directory = (dir.path / "contest").string();
+        Contest contest(directory);
+        CHECK(!contest.load());
+        CHECK(contest.create(makeConfig()));
+        CHECK(contest.hasProblem("A"));
+        CHECK(!contest.hasProblem("C"));
+        CHECK(contest.isRunning(START));
+        CHECK(!contest.isRunning(START + 300 * MINUTE));
+        CHECK(!contest.isFrozen(START + 239 * MINUTE));
+        CHECK(contest.isFrozen(START + 240 * MINUTE));
+
+        CHECK(contest.submit("alice", "A", Verdict::Accepted, 3, 3, START + 10 * MINUTE));
+        CHECK(contest.submit("bob", "A", Verdict::WrongAnswer, 1, 3, START + 20 * MINUTE));
+        CHECK(!contest.submit("bob", "C", Verdict::Accepted, 3, 3, START + 21 * MINUTE));   // 不屬於比賽
+        CHECK(!contest.submit("bob", "A", Verdict::Accepted, 3, 3, START - 1));             // 比賽開始前
+        CHECK(!contest.submit("bob", "A", Verdict::Accepted, 3, 3, START + 300 * MINUTE));  // 比賽結束後
+        CHECK(!contest.submit("bo,b", "A", Verdict::Accepted, 3, 3, START + 22 * MINUTE));  // 會讓紀錄錯位的名稱
+        CHECK(!contest.submit("", "A", Verdict::Accepted, 3, 3, START + 22 * MINUTE));
+
+        // 封榜後的提交：即時排行榜更新，公開排行榜只標示待定
+        CHECK(contest.submit("bob", "A", Verdict::Accepted, 3, 3, START + 250 * MINUTE));
+        CHECK(contest.submit("bob", "B", Verdict::Accepted, 3, 3, START + 260 * MINUTE));
+        CHECK_EQ(contest.participants(), (size_t)2);
+        CHECK_EQ(leader(contest, true), std::string("bob"));
+        CHECK_EQ(leader(contest, false), std::string("alice"));
+        CHECK(cellsOf(contest.userRow("bob", false)) == std::vector<std::string>({"-1 ?1", "?1"}));
+        CHECK(cellsOf(contest.userRow("bob", true)) == std::vector<std::string>({"+1 (250)", "+ (260)"}));
+
+        // 重新載入時重播 submissions.csv，兩份排行榜與載入前相同
+        Contest reloaded(directory);
+        CHECK(reloaded.load());
+        CHECK_EQ(reloaded.getConfig().name, std::string("practice"));
+        CHECK(reloaded.getConfig().problems == std::vector<std::string>({"A", "B"}));
+        CHECK_EQ(reloaded.participants(), (size_t)2);
+        CHECK(cellsOf(reloaded.userRow("bob", false)) == std::vector<std::string>({"-1 ?1", "?1"}));
+        CHECK(cellsOf(reloaded.userRow("bob", true)) == std::vector<std::string>({"+1 (250)", "+ (260)"}));
+
+        // 比賽已結束，公布結果後公開排行榜與即時排行榜相同，重新載入後仍維持
+        CHECK(reloaded.unfreeze());
+        CHECK_EQ(leader(reloaded, false), std::string("bob"));
+        Contest unfrozen(directory);
+        CHECK(unfrozen.load());
+        CHECK(unfrozen.getConfig().unfrozen);
+        CHECK(cellsOf(unfrozen.userRow("bob", false)) == std::vector<std::string>({"+1 (250)", "+ (260)"}));
+
+        // 排行榜輸出
+        std::string exported = unfrozen.exportSnapshot(false);
+        CHECK(!exported.empty());
+        std::ifstream csv(exported);
+        std::string header, first;
+        std::getline(csv, header);
+        std::getline(csv, first);
+        CHECK_EQ(header, std::string("rank,user,solved,penalty,A,B"));
+        CHECK_EQ(first, std::string("1,bob,2,530,+1 (250),+ (260)"));
+
+        // 建立新比賽時，上一場的提交紀錄改名保存，新的排行榜是空的
+        CHECK(unfrozen.create(makeConfig()));
+        CHECK(fs::exists(directory + "/submissions-" + std::to_string(START) + ".csv"));
+        CHECK(!fs::exists(directory + "/submissions.csv"));
+        CHECK_EQ(unfrozen.participants(), (size_t)0);
+        CHECK(!unfrozen.getConfig().unfrozen);
+    }
+
+    void testModeNames() {
+        ContestMode mode = ContestMode::ICPC;
+        CHECK(parseContestMode("ioi", mode));
+        CHECK(mode == ContestMode::IOI);
+        CHECK_EQ(contestModeName(mode), std::string("IOI"));
+        CHECK(!parseContestMode("acm", mode));
+        CHECK(mode == ContestMode::IOI);
+    }
+}
+
+int main() {
+    TempDir dir;
+    testIcpc();
+    testIoi();
+    testPending();
+    testContest(dir);
+    testModeNames();
+    return checkResult("ContestTest");
+}
@@ -0,0 +1,74 @@
+// CpuTest.cpp
+
+#include "Cpu.hpp"
+#include "Check.hpp"
+
+namespace {
+    using Cpus = std::vector<int>;
+
+    const Cpus eight = {0, 1, 2, 3, 4, 5, 6, 7};
+
+    // 沒有 SMT：每個邏輯核心自成一個實體核心
+    Cpus noSiblings(int cpu) { return {cpu}; }
+    // 常見的 SMT 編號：cpu 與 cpu ^ 4 在同一個實體核心
+    Cpus pairedSiblings(int cpu) { return {cpu & 3, (cpu & 3) + 4}; }
+
+    void testParseCpuList() {
+        CHECK(parseCpuList("0-3,8,10-11") == Cpus({0, 1, 2, 3, 8, 10, 11}));
+        CHECK(parseCpuList("3,1,1-2") == Cpus({1, 2, 3}));          // 排序並去除重複
+        CHECK(parseCpuList("x,2,-1,5-,3-1") == Cpus({2}));          // 格式錯誤或反向的範圍略過
+        CHECK(parseCpuList("4095,4096,0-100000") == Cpus({4095})); // 超出範圍的值不展開
+        CHECK(parseCpuList("").empty());
+    }
+
+    void testDefaultLayout() {
+        // 保留約四分之一給判題系統與編譯
+        CoreLayout layout = planCores(eight, "", false, noSiblings);
+        CHECK(layout.judge == Cpus({2, 3, 4, 5, 6, 7}));
+        CHECK(layout.housekeeping == Cpus({0, 1}));
+
+        layout = planCores({0, 1}, "", false, noSiblings);
+        CHECK(layout.judge == Cpus({1}));
+        CHECK(layout.housekeeping == Cpus({0}));
+
+        // 只有一個核心時無法分開
+        layout = planCores({0}, "", false, noSiblings);
+        CHECK(layout.judge == Cpus({0}));
+        CHECK(layout.housekeeping.empty());
+    }
+
+    void testSmt() {
+        // 每個實體核心只取一個邏輯核心，housekeeping 不會落在評測核心的 sibling 上
+        CoreLayout layout = planCores(eight, "", true, pairedSiblings);
+        CHECK(layout.judge == Cpus({1, 2, 3}));
+        CHECK(layout.housekeeping == Cpus({0, 4}));
+
+        layout = planCores(eight, "0-7", true, pairedSiblings);
+        CHECK(layout.judge == Cpus({1, 2, 3}));
+        CHECK(layout.housekeeping == Cpus({0, 4}));
+    }
+
+    void testRequested() {
+        CoreLayout layout = planCores(eight, "2-3", false, noSiblings);
+        CHECK(layout.judge == Cpus({2, 3}));
+        CHECK(layout.housekeeping == Cpus({0, 1, 4, 5, 6, 7}));
+
+        // 指定所有核心時仍保留第一個給判題系統
+        layout = planCores(eight, "0-7", false, noSiblings);
+        CHECK(layout.judge == Cpus({1, 2, 3, 4, 5, 6, 7}));
+        CHECK(layout.housekeeping == Cpus({0}));
+
+        // 指定的核心都不可用時視為未設定
+        layout = planCores(eight, "12-13", false, noSiblings);
+        CHECK(layout.judge == Cpus({2, 3, 4, 5, 6, 7}));
+        CHECK(layout.housekeeping == Cpus({0, 1}));
+    }
+}
+
+int main() {
+    testParseCpuList();
+    testDefaultLayout();
+    testSmt();
+    testRequested();
+    return checkResult("CpuTest");
+}
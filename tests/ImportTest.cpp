@@ -0,0 +1,220 @@
+// ImportTest.cpp
+
+#include "Import.hpp"
+#include "Check.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+
+namespace {
+    // 在記憶體中組出 tar 封存檔，可以產生 ustar prefix、GNU 長檔名、pax header 等各種格式
+    class TarBuilder {
+    public:
+        struct Header {
+            std::string name;
+            char type = '0';
+            std::string prefix;          // ustar 的 prefix 欄位
+            long long sizeField = -1;    // header 中記錄的大小，-1 表示使用內容長度
+            bool base256 = false;        // 以 base-256 記錄大小 (超過 8 GB 的檔案使用的格式)
+            bool badChecksum = false;
+
+            Header(std::string name, char type = '0') : name(std::move(name)), type(type) {}
+            Header& withPrefix(std::string p) { prefix = std::move(p); return *this; }
+            Header& withSizeField(long long size) { sizeField = size; return *this; }
+            Header& withBase256() { base256 = true; return *this; }
+            Header& withBadChecksum() { badChecksum = true; return *this; }
+        };
+
+        TarBuilder& add(const Header& header, const std::string& content) {
+            char block[512] = {};
+            std::strncpy(block, header.name.c_str(), 100);
+            std::snprintf(block + 100, 8, "%07o", 0644);
+            std::snprintf(block + 108, 8, "%07o", 0);
+            std::snprintf(block + 116, 8, "%07o", 0);
+            unsigned long long size = header.sizeField >= 0 ? (unsigned long long)header.sizeField : content.size();
+            if (header.base256) {
+                block[124] = (char)0x80;
+                for (int i = 11; i >= 1; --i, size >>= 8) block[124 + i] = (char)(size & 0xff);
+            } else {
+                std::snprintf(block + 124, 12, "%011llo", size);
+            }
+            std::snprintf(block + 136, 12, "%011o", 0);
+            block[156] = header.type;
+            std::memcpy(block + 257, "ustar", 6);
+            std::memcpy(block + 263, "00", 2);
+            std::strncpy(block + 345, header.prefix.c_str(), 155);
+
+            std::memset(block + 148, ' ', 8);
+            unsigned sum = 0;
+            for (unsigned char c : block) sum += c;
+            if (header.badChecksum) sum += 1;
+            std::snprintf(block + 148, 8, "%06o", sum);
+
+            data.append(block, 512);
+            data += content;
+            data.append((512 - content.size() % 512) % 512, '\0');
+            return *this;
+        }
+
+        TarBuilder& file(const std::string& name, const std::string& content) {
+            return add(Header(name), content);
+        }
+
+        // GNU 長檔名：內容為下一個項目的完整路徑
+        TarBuilder& longName(const std::string& name) {
+            return add(Header("././@LongLink", 'L'), name + '\0');
+        }
+
+        // pax extended header："<長度> <key>=<value>\n"，長度包含自己
+        TarBuilder& pax(const std::vector<std::pair<std::string, std::string>>& records) {
+            std::string body;
+            for (const auto& [key, value] : records) {
+                std::string record = " " + key + "=" + value + "\n";
+                size_t length = record.size() + 1;
+                while (std::to_string(length).size() + record.size() != length) ++length;
+                body += std::to_string(length) + record;
+            }
+            return add(Header("PaxHeaders/x", 'x'), body);
+        }
+
+        std::string finish(bool withEndBlocks = true) const {
+            return withEndBlocks ? data + std::string(1024, '\0') : data;
+        }
+
+    private:
+        std::string data;
+    };
+
+    using Header = TarBuilder::Header;
+
+    std::string readAll(const fs::path& path) {
+        std::ifstream in(path, std::ios::binary);
+        std::stringstream ss;
+        ss << in.rdbuf();
+        return ss.str();
+    }
+
+    // 寫出封存檔並解開到新的暫存資料夾
+    bool extract(const TempDir& dir, const std::string& archive, ImportReport& report,
+                 const std::string& name = "archive.tar") {
+        static int counter = 0;
+        std::ofstream(dir.file(name), std::ios::binary) << archive;
+        return extractTestArchive(dir.file(name), dir.path / ("staging" + std::to_string(counter++)), report);
+    }
+
+    fs::path lastStaging(const TempDir& dir) {
+        fs::path newest;
+        for (int i = 0; fs::exists(dir.path / ("staging" + std::to_string(i))); ++i) {
+            newest = dir.path / ("staging" + std::to_string(i));
+        }
+        return newest;
+    }
+
+    void testLayouts(const TempDir& dir) {
+        const std::string bigInput(5 * 1024 * 1024 + 3, 'z'); // 超過一個寫入區塊
+        const std::string deepPath = std::string(140, 'd') + "/3.in";
+
+        TarBuilder tar;
+        tar.add(Header("cases", '5'), "")
+           .file("cases/1.in", "1 2\n")
+           .file("cases/1.out", "3\n")
+           .add(Header("2.in").withPrefix("some/ustar/prefix"), bigInput)
+           .file("2.out", "big\n")
+           .longName(deepPath)
+           .file("ignored-short-name", "gnu long name\n")
+           .file("3.out", "3 out\n")
+           .pax({{"path", "pax/dir/4.in"}, {"mtime", "1.5"}})
+           .file("ignored", "pax path\n")
+           .pax({{"size", "7"}})
+           .add(Header("4.out").withSizeField(0), "pax 4\n\n") // header 記錄 0，實際大小取 pax 的 size
+           .add(Header("5.in").withBase256(), "base256")
+           .file("5.out", "ok\n")
+           .file("description.txt", "Add two numbers.\n")
+           .file("README.md", "not a test case\n")
+           .file(".6.in", "hidden\n");
+
+        ImportReport report;
+        CHECK(extract(dir, tar.finish(), report));
+        CHECK_EQ(report.error, std::string(""));
+        CHECK_EQ(report.cases, (size_t)5);
+        CHECK_EQ(report.skipped, (size_t)2);
+        CHECK(report.hasDescription);
+
+        fs::path staging = lastStaging(dir);
+        CHECK_EQ(readAll(staging / "1.in"), std::string("1 2\n"));
+        CHECK(readAll(staging / "2.in") == bigInput);
+        CHECK_EQ(readAll(staging / "3.in"), std::string("gnu long name\n"));
+        CHECK_EQ(readAll(staging / "4.in"), std::string("pax path\n"));
+        CHECK_EQ(readAll(staging / "4.out"), std::string("pax 4\n\n"));
+        CHECK_EQ(readAll(staging / "5.in"), std::string("base256"));
+        CHECK(!fs::exists(staging / "README.md"));
+        CHECK(!fs::exists(staging / ".6.in"));
+
+        // 同一份內容以 gzip 壓縮後匯入結果相同
+        std::string gzipCmd = "gzip -c '" + dir.file("archive.tar") + "' > '" + dir.file("archive.tar.gz") + "'";
+        if (std::system(gzipCmd.c_str()) == 0) {
+            ImportReport gz;
+            CHECK(extractTestArchive(dir.file("archive.tar.gz"), dir.path / "staging-gz", gz));
+            CHECK_EQ(gz.cases, (size_t)5);
+            CHECK(readAll(dir.path / "staging-gz" / "2.in") == bigInput);
+        }
+    }
+
+    void expectFailure(const TempDir& dir, const std::string& archive, const std::string& errorPart) {
+        ImportReport report;
+        CHECK(!extract(dir, archive, report));
+        if (report.error.find(errorPart) == std::string::npos) {
+            std::cerr << "unexpected error: \"" << report.error << "\", expected \"" << errorPart << "\"\n";
+            ++checkFailures();
+        }
+    }
+
+    void testErrors(const TempDir& dir) {
+        expectFailure(dir, TarBuilder().file("1.in", "x").finish(), "missing 1.out");
+        expectFailure(dir, TarBuilder().file("1.out", "x").finish(), "missing 1.in");
+        expectFailure(dir, TarBuilder().file("notes.txt", "x").finish(), "no .in/.out");
+        expectFailure(dir, TarBuilder().file("a/1.in", "x").file("b/1.in", "y").finish(), "duplicate");
+        expectFailure(dir, TarBuilder().add(Header("1.in").withBadChecksum(), "x").finish(), "checksum");
+
+        std::string truncated = TarBuilder().file("1.in", std::string(2000, 'x')).finish(false);
+        truncated.resize(1024);
+        expectFailure(dir, truncated, "truncated");
+
+        // pax 紀錄的長度與內容不符
+        TarBuilder badPax;
+        badPax.add(Header("PaxHeaders/x", 'x'), "99 path=1.in\n").file("1.in", "x");
+        expectFailure(dir, badPax.finish(), "pax");
+
+        expectFailure(dir, "", "no .in/.out");
+        ImportReport report;
+        CHECK(!extractTestArchive(dir.file("missing.tar"), dir.path / "staging-missing", report));
+        CHECK(!extractTestArchive(dir.file("archive.zip"), dir.path / "staging-zip", report));
+    }
+
+    void testReplaceDirectory(const TempDir& dir) {
+        fs::create_directories(dir.path / "target");
+        std::ofstream(dir.path / "target" / "old.in") << "old";
+        fs::create_directories(dir.path / "fresh");
+        std::ofstream(dir.path / "fresh" / "new.in") << "new";
+
+        CHECK(replaceDirectory(dir.path / "fresh", dir.path / "target"));
+        CHECK(fs::exists(dir.path / "target" / "new.in"));
+        CHECK(!fs::exists(dir.path / "target" / "old.in"));
+        CHECK(!fs::exists(dir.path / "fresh"));
+
+        // 目標不存在時直接改名
+        fs::create_directories(dir.path / "fresh2");
+        CHECK(replaceDirectory(dir.path / "fresh2", dir.path / "created"));
+        CHECK(fs::is_directory(dir.path / "created"));
+    }
+}
+
+int main() {
+    TempDir dir;
+    testLayouts(dir);
+    testErrors(dir);
+    testReplaceDirectory(dir);
+    return checkResult("ImportTest");
+}
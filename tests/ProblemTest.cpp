@@ -0,0 +1,86 @@
+// ProblemTest.cpp
+
+#include "Problem.hpp"
+#include "Sandbox.hpp"
+#include "Check.hpp"
+
+#include <fstream>
+#include <thread>
+#include <chrono>
+#include <functional>
+
+namespace {
+    // 監看在背景執行，等待條件成立 (最多 5 秒)
+    bool eventually(const std::function<bool()>& condition) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (condition()) return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        return condition();
+    }
+
+    // 以暫存檔 + rename 整個替換，與編輯器或其他程序更新檔案的方式相同
+    void replaceFile(const std::string& path, const std::string& content) {
+        std::ofstream(path + ".new") << content;
+        fs::rename(path + ".new", path);
+    }
+
+    void makeProblem(const std::string& name, const std::string& input, const std::string& output) {
+        fs::create_directories("data/problem/" + name + "/testcases");
+        std::ofstream("data/problem/" + name + "/testcases/1.in") << input;
+        std::ofstream("data/problem/" + name + "/testcases/1.out") << output;
+    }
+
+    void testSnapshots(ProblemSystem& problems) {
+        auto echo = problems.findProblem("echo");
+        CHECK(echo.has_value());
+        if (!echo) return;
+        CHECK_EQ(echo->getTimeLimitMs(), 500);
+
+        auto first = problems.testcasePrepare(*echo);
+        CHECK(first != nullptr);
+        if (!first) return;
+        CHECK_EQ(first->size(), (size_t)1);
+        CHECK(problems.testcasePrepare(*echo) == first); // 沒有變動時使用快取
+
+        // 測資被修改後重新載入，評測中拿到的舊快照內容不變
+        replaceFile("data/problem/echo/testcases/1.out", "changed\n");
+        CHECK(eventually([&] {
+            auto current = problems.testcasePrepare(*echo);
+            return current && *(*current)[0].expected == "changed\n";
+        }));
+        CHECK_EQ(*(*first)[0].expected, std::string("hello\n"));
+    }
+
+    void testCatalogReload(ProblemSystem& problems) {
+        makeProblem("second", "1\n", "1\n");
+        replaceFile("data/problem/problem.csv",
+                    "echo,data/problem/echo/,500\nsecond,data/problem/second/\n");
+        CHECK(eventually([&] { return problems.findProblem("second").has_value(); }));
+
+        auto before = problems.getProblemList();
+        replaceFile("data/problem/problem.csv", "second,data/problem/second/\n");
+        CHECK(eventually([&] { return !problems.findProblem("echo").has_value(); }));
+        CHECK_EQ(before->size(), (size_t)2); // 舊的清單快照不受影響
+        CHECK_EQ(problems.getProblemList()->size(), (size_t)1);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 2 && std::string(argv[1]) == "--sandbox-init") return sandboxInitMain(argc, argv);
+
+    // 題目、提交紀錄與比賽資料都使用相對路徑，在暫存資料夾中建立一份獨立的 data/
+    TempDir dir;
+    fs::current_path(dir.path);
+    makeProblem("echo", "hello\n", "hello\n");
+    std::ofstream("data/problem/problem.csv") << "echo,data/problem/echo/,500\n";
+
+    {
+        ProblemSystem problems;
+        problems.init("data/problem/problem.csv");
+        testSnapshots(problems);
+        testCatalogReload(problems);
+    }
+    return checkResult("ProblemTest");
+}
@@ -0,0 +1,81 @@
+// RunnerTest.cpp
+
+#include "Runner.hpp"
+#include "Sandbox.hpp"
+#include "Check.hpp"
+
+#include <fstream>
+#include <map>
+#include <mutex>
+
+namespace {
+    Testcase makeCase(const std::string& name, const std::string& input, const std::string& expected) {
+        return {name, std::make_shared<const std::string>(input), std::make_shared<const std::string>(expected)};
+    }
+
+    void testCompareOutput() {
+        CHECK(compareOutput("3\n", "3\n"));
+        CHECK(compareOutput("3\n", "3"));         // 最後一行沒有換行仍視為相同
+        CHECK(!compareOutput("3\n", "3\n4\n"));   // 多餘的輸出
+        CHECK(!compareOutput("3\n4\n", "3\n"));   // 缺少輸出
+        CHECK(!compareOutput("3\n", "3 \n"));
+        CHECK(compareOutput("", ""));
+    }
+
+    // 一次送出多份提交，檢查每一份都回報正確的結果與通過數 (編號對應呼叫端的 index)
+    void testPipeline(const TempDir& dir) {
+        auto writeCode = [&](const std::string& name, const std::string& body) {
+            std::ofstream(dir.file(name)) << "#include <iostream>\nint main() { long long a, b; std::cin >> a >> b; "
+                                          << body << " }\n";
+            return dir.file(name);
+        };
+        const std::string sum = writeCode("sum.cpp", "std::cout << a + b << \"\\n\";");
+        const std::string diff = writeCode("diff.cpp", "std::cout << a - b << \"\\n\";");
+        const std::string broken = writeCode("broken.cpp", "this does not compile");
+        const std::string crash = writeCode("crash.cpp", "return (int)(a + b);"); // 非零結束碼
+
+        auto testcases = std::make_shared<const TestcaseSet>(TestcaseSet{
+            makeCase("1", "1 2\n", "3\n"),
+            makeCase("2", "5 0\n", "5\n"),   // a - b 也會通過這一筆
+            makeCase("3", "10 20\n", "30\n"),
+        });
+
+        struct Result { Verdict verdict; size_t passed; };
+        std::map<size_t, Result> results;
+        std::mutex mutex;
+        {
+            JudgePipeline pipeline([&](size_t index, Verdict verdict, size_t passed) {
+                std::lock_guard<std::mutex> lock(mutex);
+                CHECK(!results.count(index));
+                results[index] = {verdict, passed};
+            });
+            pipeline.submit({0, sum, testcases, 2000});
+            pipeline.submit({1, diff, testcases, 2000});
+            pipeline.submit({2, diff, testcases, 2000, false, true});
+            pipeline.submit({3, broken, testcases, 2000});
+            pipeline.submit({4, crash, testcases, 2000});
+            pipeline.submit({5, sum, testcases, 2000, false, true});
+            pipeline.finish();
+        }
+
+        CHECK_EQ(results.size(), (size_t)6);
+        CHECK(results[0].verdict == Verdict::Accepted);
+        CHECK(results[1].verdict == Verdict::WrongAnswer);
+        CHECK(results[2].verdict == Verdict::WrongAnswer);
+        CHECK_EQ(results[2].passed, (size_t)1);       // 部分給分時跑完所有測資
+        CHECK(results[3].verdict == Verdict::CompileError);
+        CHECK(results[4].verdict == Verdict::RuntimeError);
+        CHECK(results[5].verdict == Verdict::Accepted);
+        CHECK_EQ(results[5].passed, (size_t)3);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // 沙箱以 /proc/self/exe --sandbox-init 重新執行自己，測試程式也要能扮演沙箱 init
+    if (argc >= 2 && std::string(argv[1]) == "--sandbox-init") return sandboxInitMain(argc, argv);
+
+    TempDir dir;
+    testCompareOutput();
+    testPipeline(dir);
+    return checkResult("RunnerTest");
+}
@@ -0,0 +1,114 @@
+// SandboxTest.cpp
+
+#include "Sandbox.hpp"
+#include "Check.hpp"
+
+#include <fstream>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/wait.h>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // 依 stdin 的第一個字決定行為的受測程式
+    const std::string probeSource = R"(#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/stat.h>
+int main() {
+    int mode = getchar();
+    if (mode == 'e') { int c; while ((c = getchar()) != EOF) putchar(c); return 0; }
+    if (mode == 'x') return 3;
+    if (mode == 'l') for (;;) {}
+    if (mode == 'f') { if (fork() == 0) { sleep(60); } return 0; }
+    if (mode == 'i') {
+        struct stat st;
+        printf("parent=%d home=%d\n", (int)getppid(), stat("/root", &st) == 0 || stat("/home", &st) == 0);
+        return 0;
+    }
+    return 1;
+}
+)";
+
+    SandboxResult runProbe(SandboxPool& pool, const std::string& binary, const std::string& input,
+                           Clock::duration timeout = std::chrono::seconds(5)) {
+        SandboxLease lease = pool.acquire();
+        CHECK(static_cast<bool>(lease));
+        if (!lease) return {};
+        SandboxRequest request;
+        request.binaryPath = binary;
+        request.cpuLimitSec = 5;
+        request.fileLimitBytes = 1 << 20;
+        return lease.run(request, input, Clock::now() + timeout);
+    }
+
+    void testRun(SandboxPool& pool, const std::string& binary) {
+        std::string text;
+        for (int i = 0; text.size() < 1024 * 1024; ++i) text += std::to_string(i) + "\n";
+        SandboxResult echoed = runProbe(pool, binary, "e" + text);
+        CHECK(echoed.ok);
+        CHECK(WIFEXITED(echoed.status) && WEXITSTATUS(echoed.status) == 0);
+        CHECK(echoed.output == text);
+
+        SandboxResult exited = runProbe(pool, binary, "x");
+        CHECK(exited.ok);
+        CHECK(WIFEXITED(exited.status) && WEXITSTATUS(exited.status) == 3);
+
+        SandboxResult looped = runProbe(pool, binary, "l", std::chrono::milliseconds(300));
+        CHECK(looped.ok);
+        CHECK(looped.timedOut);
+
+        // 留下背景程序的執行結束後，沙箱清理乾淨仍可繼續使用
+        SandboxResult forked = runProbe(pool, binary, "f", std::chrono::seconds(2));
+        CHECK(forked.ok);
+        CHECK(!forked.timedOut);
+        for (int i = 0; i < 4; ++i) CHECK(runProbe(pool, binary, "x").ok);
+
+        // 受測程式在自己的 pid namespace 中，也看不到主機的家目錄
+        SandboxResult isolated = runProbe(pool, binary, "i");
+        CHECK(isolated.ok);
+        CHECK_EQ(isolated.output, std::string("parent=1 home=0\n"));
+
+        SandboxResult missing = runProbe(pool, binary + ".missing", "x");
+        CHECK(!missing.ok);
+    }
+
+    // 直接執行 --sandbox-init 必須拒絕，不能動到主機的 mount namespace
+    void testDirectInit(const TempDir& dir) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            execl("/proc/self/exe", "judge", "--sandbox-init", dir.path.c_str(), (char*)nullptr);
+            _exit(127);
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 1);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 2 && std::string(argv[1]) == "--sandbox-init") return sandboxInitMain(argc, argv);
+
+    TempDir dir;
+    testDirectInit(dir);
+
+    const std::string binary = dir.file("probe");
+    std::ofstream(dir.file("probe.cpp")) << probeSource;
+    const std::string compile = "g++ -O1 -o '" + binary + "' '" + dir.file("probe.cpp") + "'";
+    CHECK(std::system(compile.c_str()) == 0);
+
+    SandboxPool& pool = SandboxPool::instance();
+    pool.warmUp(2);
+    std::string status = pool.getStatus();
+    std::cout << "sandbox: " << status << "\n";
+    CHECK(!status.empty());
+    if (pool.enabled()) {
+        testRun(pool, binary);
+    } else {
+        // 環境不支援時停用，借不到沙箱，評測改以一般方式執行
+        CHECK(status.rfind("disabled (", 0) == 0);
+        CHECK(!pool.acquire());
+    }
+    return checkResult("SandboxTest");
+}
@@ -0,0 +1,159 @@
+// SimilarityTest.cpp
+
+#include "Similarity.hpp"
+#include "Check.hpp"
+
+#include <fstream>
+#include <thread>
+#include <set>
+#include <algorithm>
+
+namespace {
+    const std::string original = R"(#include <iostream>
+#include <vector>
+using namespace std;
+int main() {
+    int n;
+    cin >> n;
+    vector<long long> values(n);
+    for (int i = 0; i < n; i++) cin >> values[i];
+    long long best = values[0], current = 0;
+    for (int i = 0; i < n; i++) {
+        current = max(values[i], current + values[i]);
+        best = max(best, current);
+    }
+    cout << best << endl;
+    return 0;
+}
+)";
+
+    // 改變數名稱、數字、空白與註解
+    const std::string disguised = R"(#include <iostream>
+#include <vector>
+using namespace std;
+// maximum subarray
+int main(){int count;cin>>count;
+  vector<long long> arr(count);
+  for(int k=0;k<count;k++) cin>>arr[k];   /* read */
+  long long answer=arr[7],run=1;
+  for(int k=0;k<count;k++){run=max(arr[k],run+arr[k]);answer=max(answer,run);}
+  cout<<answer<<endl;return 0;}
+)";
+
+    const std::string unrelated = R"(#include <cstdio>
+#include <cstring>
+char grid[105][105];
+int seen[105][105], rows, cols;
+void fill(int r, int c) {
+    if (r < 0 || c < 0 || r >= rows || c >= cols || seen[r][c] || grid[r][c] != '#') return;
+    seen[r][c] = 1;
+    fill(r + 1, c); fill(r - 1, c); fill(r, c + 1); fill(r, c - 1);
+}
+int main() {
+    scanf("%d %d", &rows, &cols);
+    for (int i = 0; i < rows; ++i) scanf("%s", grid[i]);
+    int islands = 0;
+    for (int i = 0; i < rows; ++i)
+        for (int j = 0; j < cols; ++j)
+            if (grid[i][j] == '#' && !seen[i][j]) { fill(i, j); ++islands; }
+    printf("%d\n", islands);
+}
+)";
+
+    std::vector<uint64_t> hashes(const std::string& source) {
+        std::vector<uint64_t> out;
+        for (const auto& fp : fingerprintSource(source, 12, 8)) out.push_back(fp.hash);
+        return out;
+    }
+
+    void testFingerprints() {
+        CHECK(!hashes(original).empty());
+        CHECK(hashes(original) == hashes(disguised));
+        CHECK(hashes(original) != hashes(unrelated));
+        CHECK(fingerprintSource("int main() {}", 12, 8).empty()); // token 數不足 k
+
+        // 指紋的行數範圍落在原始碼之內
+        for (const auto& fp : fingerprintSource(original, 12, 8)) {
+            CHECK(fp.firstLine >= 1);
+            CHECK(fp.firstLine <= fp.lastLine);
+            CHECK(fp.lastLine <= 16);
+        }
+    }
+
+    void write(const TempDir& dir, const std::string& name, const std::string& source) {
+        std::ofstream(dir.file(name)) << source;
+    }
+
+    void testIndex(const TempDir& dir) {
+        write(dir, "a.cpp", original);
+        write(dir, "b.cpp", disguised);
+        write(dir, "c.cpp", unrelated);
+
+        SimilarityIndex index(12, 8, 0.5);
+        CHECK(index.add(dir.file("a.cpp")).empty());
+        CHECK(index.add(dir.file("c.cpp")).empty());
+
+        auto matches = index.add(dir.file("b.cpp"));
+        CHECK_EQ(matches.size(), (size_t)1);
+        if (matches.size() == 1) {
+            CHECK_EQ(matches[0].pathA, dir.file("b.cpp"));
+            CHECK_EQ(matches[0].pathB, dir.file("a.cpp"));
+            CHECK(matches[0].score > 0.99);
+            CHECK(!matches[0].regions.empty());
+        }
+        CHECK_EQ(index.size(), (size_t)3);
+
+        // 同一路徑重新加入時不與自己的舊版本比對
+        auto again = index.add(dir.file("c.cpp"));
+        CHECK(again.empty());
+        CHECK_EQ(index.size(), (size_t)3);
+        CHECK(index.add(dir.file("missing.cpp")).empty());
+    }
+
+    // 出現在超過 MAX_POSTINGS 份文件中的指紋視為樣板，不再參與比對
+    void testBoilerplate(const TempDir& dir) {
+        SimilarityIndex index(12, 8, 0.5);
+        size_t matched = 0;
+        for (size_t i = 0; i <= SimilarityIndex::MAX_POSTINGS + 1; ++i) {
+            const std::string name = "copy" + std::to_string(i) + ".cpp";
+            write(dir, name, original);
+            matched += index.add(dir.file(name)).empty() ? 0 : 1;
+        }
+        CHECK(index.commonCount() > 0);
+        CHECK(matched >= SimilarityIndex::MAX_POSTINGS);
+    }
+
+    // 多個執行緒同時加入互相抄襲的提交，每一對仍然恰好回報一次
+    void testConcurrentAdd(const TempDir& dir) {
+        constexpr int THREADS = 8;
+        for (int i = 0; i < THREADS; ++i) write(dir, "p" + std::to_string(i) + ".cpp", i % 2 ? disguised : original);
+
+        SimilarityIndex index(12, 8, 0.5);
+        std::vector<std::vector<SimilarityMatch>> results(THREADS);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < THREADS; ++i) {
+            threads.emplace_back([&, i] { results[i] = index.add(dir.file("p" + std::to_string(i) + ".cpp")); });
+        }
+        for (auto& thread : threads) thread.join();
+
+        std::set<std::pair<std::string, std::string>> pairs;
+        size_t total = 0;
+        for (const auto& list : results) {
+            for (const auto& m : list) {
+                pairs.insert(std::minmax(m.pathA, m.pathB));
+                ++total;
+            }
+        }
+        CHECK_EQ(pairs.size(), (size_t)THREADS * (THREADS - 1) / 2);
+        CHECK_EQ(total, pairs.size());
+    }
+}
+
+int main() {
+    TempDir dir;
+    testFingerprints();
+    testIndex(dir);
+    testBoilerplate(dir);
+    testConcurrentAdd(dir);
+    return checkResult("SimilarityTest");
+}
@@ -0,0 +1,70 @@
+// TraceTest.cpp
+
+#include "Trace.hpp"
+#include "Check.hpp"
+
+#include <fstream>
+#include <sstream>
+
+namespace {
+    std::string readAll(const std::string& path) {
+        std::ifstream in(path);
+        std::stringstream ss;
+        ss << in.rdbuf();
+        return ss.str();
+    }
+
+    // 含有 , " 與換行的欄位寫入後可以原樣讀回，程式碼會另存一份快照
+    void testRoundTrip(const TempDir& dir) {
+        const std::string code = dir.file("a,b.cpp");
+        std::ofstream(code) << "int main() {}\n";
+
+        TraceRecorder recorder(dir.file("trace.csv"), dir.file("snapshots"));
+        auto now = std::chrono::system_clock::now();
+        recorder.record(now, "bob,\"x\"", "Two, Sum", code, Verdict::WrongAnswer);
+        recorder.record(now - std::chrono::seconds(5), "alice", "multi\nline", "missing.cpp", Verdict::CompileError);
+
+        auto trace = loadTrace(dir.file("trace.csv"));
+        CHECK_EQ(trace.size(), (size_t)2);
+        if (trace.size() != 2) return;
+
+        // 依到達時間排序
+        CHECK_EQ(trace[0].username, std::string("alice"));
+        CHECK_EQ(trace[0].problemTitle, std::string("multi\nline"));
+        CHECK_EQ(trace[0].sourcePath, std::string("missing.cpp")); // 檔案不存在時保留原路徑
+        CHECK(trace[0].verdict == Verdict::CompileError);
+
+        CHECK_EQ(trace[1].username, std::string("bob,\"x\""));
+        CHECK_EQ(trace[1].problemTitle, std::string("Two, Sum"));
+        CHECK(trace[1].verdict == Verdict::WrongAnswer);
+        CHECK(trace[1].sourcePath != code);
+        CHECK_EQ(readAll(trace[1].sourcePath), std::string("int main() {}\n"));
+        CHECK(trace[0].arrivalMs < trace[1].arrivalMs);
+    }
+
+    // 沒有引號的舊格式照常讀取，格式錯誤的行略過
+    void testLegacyAndMalformed(const TempDir& dir) {
+        const std::string path = dir.file("legacy.csv");
+        std::ofstream(path) << "2000,carol,sum,data/user/program/sum.cpp,AC\r\n"
+                            << "\n"
+                            << "not-a-number,dave,sum,x.cpp,AC\n"
+                            << "1000,erin,sum,x.cpp,XX\n"
+                            << "1500,frank,sum,x.cpp\n"
+                            << "1000,grace,sum,x.cpp,TLE\n";
+        auto trace = loadTrace(path);
+        CHECK_EQ(trace.size(), (size_t)2);
+        if (trace.size() != 2) return;
+        CHECK_EQ(trace[0].username, std::string("grace"));
+        CHECK(trace[0].verdict == Verdict::TimeLimitExceeded);
+        CHECK_EQ(trace[1].username, std::string("carol"));
+        CHECK_EQ(trace[1].sourcePath, std::string("data/user/program/sum.cpp"));
+        CHECK(trace[1].verdict == Verdict::Accepted);
+    }
+}
+
+int main() {
+    TempDir dir;
+    testRoundTrip(dir);
+    testLegacyAndMalformed(dir);
+    return checkResult("TraceTest");
+}
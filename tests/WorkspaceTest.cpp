@@ -0,0 +1,54 @@
+// WorkspaceTest.cpp
+
+#include "Workspace.hpp"
+#include "Check.hpp"
+
+#include <fstream>
+#include <set>
+#include <unistd.h>
+
+namespace {
+    // 同時借出的工作區互不相同，且都在 pool 的根目錄下 (根目錄帶有 pid，多個判題程序不會共用)
+    void testDistinctLeases() {
+        WorkspacePool& pool = WorkspacePool::instance();
+        const std::string root = pool.getRoot().string();
+        CHECK(root.find(std::to_string(getpid())) != std::string::npos);
+
+        std::vector<WorkspaceLease> leases;
+        std::set<std::string> binaries;
+        for (int i = 0; i < 4; ++i) {
+            leases.push_back(pool.acquire());
+            const std::string binary = leases.back().target().binaryPath;
+            CHECK(binary.compare(0, root.size(), root) == 0);
+            binaries.insert(binary);
+        }
+        CHECK_EQ(binaries.size(), (size_t)4);
+    }
+
+    // 歸還後重複使用同一個工作區 (不重新建立資料夾)
+    void testReuse() {
+        WorkspacePool& pool = WorkspacePool::instance();
+        std::string first;
+        {
+            WorkspaceLease lease = pool.acquire();
+            first = lease.target().binaryPath;
+            std::ofstream(first) << "stale binary";
+            CHECK(fs::exists(first));
+        }
+        WorkspaceLease again = pool.acquire();
+        CHECK_EQ(again.target().binaryPath, first);
+
+        // 重複歸還不會把同一個工作區放回兩次，之後同時借出的兩個工作區仍然不同
+        again.release();
+        again.release();
+        WorkspaceLease a = pool.acquire();
+        WorkspaceLease b = pool.acquire();
+        CHECK(a.target().binaryPath != b.target().binaryPath);
+    }
+}
+
+int main() {
+    testDistinctLeases();
+    testReuse();
+    return checkResult("WorkspaceTest");
+}
@@ -0,0 +1,39 @@
+#!/usr/bin/env bash
+# 編譯並執行 tests/ 下的所有測試：src/*.cpp (不含 main.cpp) 先編成 object，再與每個 *Test.cpp 連結。
+# 用法：tests/run.sh            執行全部
+#       tests/run.sh Contest    只執行 ContestTest.cpp
+set -u
+cd "$(dirname "$0")/.."
+
+CXX=${CXX:-g++}
+CXXFLAGS="-I include -I tests -std=c++17 -Wall -Wextra -pthread"
+OUT=build/tests
+mkdir -p "$OUT/obj"
+
+# 只重新編譯有變動的原始檔 (標頭變動時全部重編)
+newestHeader=$(ls -t include/*.hpp | head -n 1)
+for src in src/*.cpp; do
+    obj="$OUT/obj/$(basename "${src%.cpp}").o"
+    if [ ! -f "$obj" ] || [ "$src" -nt "$obj" ] || [ "$newestHeader" -nt "$obj" ]; then
+        echo "$src $obj"
+    fi
+done | xargs -r -n 2 -P "$(nproc)" sh -c "$CXX $CXXFLAGS -c \"\$0\" -o \"\$1\"" || exit 1
+
+if [ $# -gt 0 ]; then
+    tests=()
+    for name in "$@"; do tests+=("tests/${name}Test.cpp"); done
+else
+    tests=(tests/*Test.cpp)
+fi
+
+failed=0
+for test in "${tests[@]}"; do
+    name=$(basename "${test%.cpp}")
+    if ! $CXX $CXXFLAGS "$test" "$OUT"/obj/*.o -o "$OUT/$name"; then
+        echo "$name: build failed"
+        failed=1
+        continue
+    fi
+    "./$OUT/$name" || failed=1
+done
+exit $failed